@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BinarySearchTree.h"
+#include "StaticSearchIndex.h"
+#include "StructureOfArrays.h"
+
+using namespace utilities;
+
+// Lookup throughput of the tree balancing policies on uniform and Zipfian key traces, of the
+// frozen indexes against std::lower_bound on a uniform trace, and the SoA record sorts:
+//
+//    g++ -std=c++17 -O2 Benchmarks.cpp -o Benchmarks && ./Benchmarks [keys] [lookups]
+
+namespace
+{
+
+// Lookup keys drawn from keys, rank r being picked with probability proportional to 1 / r^s;
+// ranks are assigned to keys at random so hot keys are spread over the whole key range.
+std::vector<int> ZipfTrace (std::vector<int> const & keys, std::size_t length, double s, std::mt19937 & random)
+{
+   std::vector<double> weights (keys.size ());
+
+   for (std::size_t rank = 0; rank < weights.size (); ++rank) weights [rank] = 1.0 / std::pow (double (rank + 1), s);
+
+   auto hot = keys;
+   std::shuffle (hot.begin (), hot.end (), random);
+
+   std::discrete_distribution<std::size_t> distribution (weights.begin (), weights.end ());
+
+   std::vector<int> trace (length);
+
+   for (auto & key : trace) key = hot [distribution (random)];
+
+   return trace;
+}
+
+std::vector<int> UniformTrace (std::vector<int> const & keys, std::size_t length, std::mt19937 & random)
+{
+   std::uniform_int_distribution<std::size_t> distribution (0, keys.size () - 1);
+
+   std::vector<int> trace (length);
+
+   for (auto & key : trace) key = keys [distribution (random)];
+
+   return trace;
+}
+
+template <typename TreeT>
+void Run (char const * policy, std::vector<int> const & insertions, std::vector<std::pair<std::string, std::vector<int>>> const & traces)
+{
+   TreeT tree;
+
+   for (auto key : insertions) tree.emplace (key);
+
+   for (auto const & [name, trace] : traces)
+   {
+      long long found = 0;
+
+      auto const start = std::chrono::steady_clock::now ();
+
+      for (auto key : trace) found += tree.find (key) != tree.end ();
+
+      auto const elapsed = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+
+      std::printf ("%-16s %-12s %8.1f ns/find  (%lld hits)\n", policy, name.c_str (), elapsed / double (trace.size ()), found);
+   }
+}
+
+// lowerBound (key) returns the first element not less than key, as a pointer or iterator.
+template <typename LowerBoundT>
+void RunLowerBound (char const * layout, std::vector<int> const & trace, LowerBoundT lowerBound)
+{
+   long long sum = 0;
+
+   auto const start = std::chrono::steady_clock::now ();
+
+   for (auto key : trace) sum += *lowerBound (key);
+
+   auto const elapsed = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+
+   std::printf ("%-16s %-12s %8.1f ns/lower_bound  (checksum %lld)\n", layout, "uniform", elapsed / double (trace.size ()), sum);
+}
+
+// Sorts of four field records on their int column: SortByColumn on its radix path, on its merge
+// path (any comparator but std::less), and QuickSort moving whole rows through the SoA iterators.
+void RunSoASort (std::size_t count, std::mt19937 & random)
+{
+   using Records = SoA<tmp::TypeSequence<int, double, long long, long long>>;
+
+   Records records;
+   records.reserve (count);
+
+   for (std::size_t index = 0; index < count; ++index) records.emplace_back (static_cast<int> (random ()), 1.0, 2LL, 3LL);
+
+   auto time = [&records] (char const * path, auto sort)
+   {
+      auto sorted = records;
+
+      auto const start = std::chrono::steady_clock::now ();
+
+      sort (sorted);
+
+      auto const elapsed = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+
+      auto const keys = sorted.column<0> ();
+
+      std::printf ("%-16s %-12s %8.1f ms  (%zu records, %s)\n", "soa sort", path, elapsed, keys.size (), std::is_sorted (keys.begin (), keys.end ()) ? "sorted" : "NOT sorted");
+   };
+
+   time ("radix", [] (Records & sorted) {sorted.SortByColumn<0> ();});
+   time ("merge", [] (Records & sorted) {sorted.SortByColumn<0> ([] (int left, int right) {return left < right;});});
+   time ("quicksort", [] (Records & sorted) {QuickSort (sorted.begin (), sorted.end (), [] (auto const & left, auto const & right) {return get<0> (left) < get<0> (right);});});
+}
+
+}
+
+int main (int argc, char** argv)
+{
+   std::size_t const keyCount = argc > 1 ? std::stoul (argv [1]) : 1 << 20;
+   std::size_t const lookups  = argc > 2 ? std::stoul (argv [2]) : 1 << 22;
+
+   std::mt19937 random (42);
+
+   std::vector<int> keys (keyCount);
+   std::iota (keys.begin (), keys.end (), 0);
+
+   // Random insertion order keeps the unbalanced tree at its expected O(log n) depth.
+   auto insertions = keys;
+   std::shuffle (insertions.begin (), insertions.end (), random);
+
+   std::vector<std::pair<std::string, std::vector<int>>> traces;
+
+   traces.emplace_back ("uniform", UniformTrace (keys, lookups, random));
+   traces.emplace_back ("zipf-0.8", ZipfTrace (keys, lookups, 0.8, random));
+   traces.emplace_back ("zipf-1.2", ZipfTrace (keys, lookups, 1.2, random));
+   traces.emplace_back ("zipf-1.5", ZipfTrace (keys, lookups, 1.5, random));
+
+   std::printf ("%zu keys, %zu lookups per trace\n", keyCount, lookups);
+
+   Run<BinarySearchTree<int>> ("unbalanced", insertions, traces);
+   Run<BinarySearchTree<int, std::less<int>, tree_options::WeightBalanced>> ("weight-balanced", insertions, traces);
+   Run<BinarySearchTree<int, std::less<int>, tree_options::Splay>> ("splay", insertions, traces);
+   Run<BinarySearchTree<int, std::less<int>, tree_options::SparseSplay<16>>> ("sparse-splay-16", insertions, traces);
+
+   BinarySearchTree<int> tree (sorted_unique, keys.begin (), keys.end ());
+   StaticSearchIndex<int> eytzinger (keys.begin (), keys.end ());
+   StaticBlockSearchIndex<int> blocks (keys.begin (), keys.end ());
+
+   auto const & uniform = traces.front ().second;
+
+   RunLowerBound ("std::lower_bound", uniform, [&keys] (int key) {return std::lower_bound (keys.begin (), keys.end (), key);});
+   RunLowerBound ("balanced tree", uniform, [&tree] (int key) {return tree.lower_bound (key);});
+   RunLowerBound ("eytzinger", uniform, [&eytzinger] (int key) {return eytzinger.lower_bound (key);});
+   RunLowerBound ("b+ blocks", uniform, [&blocks] (int key) {return blocks.lower_bound (key);});
+
+   RunSoASort (keyCount, random);
+}
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <functional>
+#include <future>
+#include <iterator>
 #include <memory>
 #include <stack>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -23,10 +29,100 @@ struct AssignOnConst <const ArgT, ResT>
    using type = ResT const;
 };
 
-template < typename PayloadT, typename CompareT = std::less <PayloadT> >
+namespace tree_options
+{
+
+// Maintains subtree sizes in every node: enables rank / select / count_range and
+// logarithmic iterator advance / distance at the price of a size_t per node.
+struct OrderStatistics {};
+
+// Links every node to its in-order neighbours so that iteration is a plain pointer walk,
+// at the price of two pointers per node.
+struct Threaded {};
+
+// Keeps every subtree weight balanced (BB[alpha]) through rotations on insert and erase.
+// Implies OrderStatistics, whose subtree sizes serve as the weights.
+struct WeightBalanced {};
+
+// Splays inserted nodes and every node reached by a mutable find to the root, so that frequently
+// accessed keys drift to the top and skewed lookups stop paying the full depth. Insertions and
+// successful mutable finds cost amortized O(log n); misses and lookups through a const tree never
+// reshape it, so they pay the current depth. Excludes WeightBalanced.
+struct Splay {};
+
+// Splay that only splays every PeriodV-th successful mutable find (insertions are still splayed),
+// keeping most lookups read-only. This gives up the amortized O(log n) bound: after ascending
+// inserts leave a chain, the PeriodV - 1 finds between two splays may each cost O(n).
+template <unsigned PeriodV>
+struct SparseSplay { static_assert (PeriodV > 0, "the splay period must be positive"); };
+
+}
+
+template <typename OptionT, typename... OptionsT>
+constexpr bool HasOption = std::disjunction_v <std::is_same <OptionT, OptionsT>...>;
+
+// Number of successful mutable finds per splay selected by a tree option, 0 when it splays nothing.
+template <typename OptionT>
+constexpr unsigned SplayPeriodOf = 0;
+
+template <>
+constexpr unsigned SplayPeriodOf <tree_options::Splay> = 1;
+
+template <unsigned PeriodV>
+constexpr unsigned SplayPeriodOf <tree_options::SparseSplay<PeriodV>> = PeriodV;
+
+// Tags a range as already sorted and free of duplicates, so it can be bulk loaded in O(n).
+struct sorted_unique_t { explicit sorted_unique_t () = default; };
+
+inline constexpr sorted_unique_t sorted_unique {};
+
+template <bool EnabledV>
+class SubTreeSize
+{
+public:
+   void size (std::size_t) {}
+};
+
+template <>
+class SubTreeSize <true>
+{
+public:
+   std::size_t size () const {return i_size;}
+   void        size (std::size_t size) {i_size = size;}
+
+private:
+   std::size_t i_size = 1;
+};
+
+template <bool EnabledV, typename NodeT>
+class InOrderThreads
+{
+public:
+   void next (NodeT *) {}
+   void prev (NodeT *) {}
+};
+
+template <typename NodeT>
+class InOrderThreads <true, NodeT>
+{
+public:
+   NodeT const *  next () const {return i_next;}
+   NodeT *        next () {return i_next;}
+   void           next (NodeT * node) {i_next = node;}
+
+   NodeT const *  prev () const {return i_prev;}
+   NodeT *        prev () {return i_prev;}
+   void           prev (NodeT * node) {i_prev = node;}
+
+private:
+   NodeT * i_next = nullptr;
+   NodeT * i_prev = nullptr;
+};
+
+template < typename PayloadT, typename CompareT = std::less <PayloadT>, typename... OptionsT >
 class BinarySearchTree
 {
-   using Self_t = BinarySearchTree<PayloadT, CompareT>;
+   using Self_t = BinarySearchTree<PayloadT, CompareT, OptionsT...>;
 public:
 
    #pragma region Construction, Dectruction, Assignment
@@ -39,6 +135,14 @@ public:
 
    BinarySearchTree (std::initializer_list<PayloadT> && Args);
 
+   // O(n) bulk build of a perfectly balanced tree; [first, last) must be strictly increasing.
+   template <typename IteratorT>
+   BinarySearchTree (sorted_unique_t, IteratorT first, IteratorT last);
+
+   // Copies the upper levels of tree sequentially and the subtrees below them on up to
+   // threads threads (0: one per hardware thread).
+   BinarySearchTree (BinarySearchTree const & tree, unsigned threads);
+
    BinarySearchTree & operator = (BinarySearchTree const &);
 
    BinarySearchTree & operator = (BinarySearchTree &&);
@@ -81,44 +185,174 @@ public:
 
    #pragma region Accessors
 
+   using size_type         = std::size_t;
+
+   using difference_type   = std::ptrdiff_t;
+
+   using range_t           = std::pair<iterator, iterator>;
+
+   using const_range_t     = std::pair<const_iterator, const_iterator>;
+
    const_iterator find  (PayloadT const & value) const noexcept;
 
    iterator       find  (PayloadT const & value) noexcept;
 
+   // First element not less than value.
+   const_iterator lower_bound (PayloadT const & value) const noexcept;
+
+   iterator       lower_bound (PayloadT const & value) noexcept;
+
+   // First element greater than value.
+   const_iterator upper_bound (PayloadT const & value) const noexcept;
+
+   iterator       upper_bound (PayloadT const & value) noexcept;
+
+   const_range_t  equal_range (PayloadT const & value) const noexcept;
+
+   range_t        equal_range (PayloadT const & value) noexcept;
+
+   // Heterogeneous lookups, available when CompareT::is_transparent is defined (e.g. std::less<>).
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator find        (KeyT const & key) const noexcept {return const_iterator (Find (key));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   iterator       find        (KeyT const & key) noexcept {return iterator (SplayLookup (const_cast<Node *> (Find (key))));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator lower_bound (KeyT const & key) const noexcept {return const_iterator (LowerBound (key));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   iterator       lower_bound (KeyT const & key) noexcept {return iterator (const_cast<Node *> (LowerBound (key)));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator upper_bound (KeyT const & key) const noexcept {return const_iterator (UpperBound (key));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   iterator       upper_bound (KeyT const & key) noexcept {return iterator (const_cast<Node *> (UpperBound (key)));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_range_t  equal_range (KeyT const & key) const noexcept {return EqualRange (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   range_t        equal_range (KeyT const & key) noexcept {return MakeMutable (EqualRange (key));}
+
    bool           empty () const noexcept;
 
+   size_type      size  () const noexcept;
+
+   #pragma endregion
+
+   #pragma region Order Statistics (tree_options::OrderStatistics only)
+
+   // Number of elements strictly less than value.
+   size_type      rank        (PayloadT const & value) const noexcept;
+
+   // Iterator to the k-th smallest element (0-based), end () if k >= number of elements.
+   const_iterator select      (size_type k) const noexcept;
+
+   iterator       select      (size_type k) noexcept;
+
+   // Number of elements in [lo, hi).
+   size_type      count_range (PayloadT const & lo, PayloadT const & hi) const noexcept;
+
+   // Heterogeneous rank and count_range, as for the lookups above.
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   size_type      rank        (KeyT const & key) const noexcept {return Rank (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   size_type      count_range (KeyT const & lo, KeyT const & hi) const noexcept {return CountRange (lo, hi);}
+
+   // Moves it by n positions in O(height); advancing past either end yields end ().
+   const_iterator advance     (const_iterator it, difference_type n) const noexcept;
+
+   iterator       advance     (iterator it, difference_type n) noexcept;
+
+   difference_type distance   (const_iterator first, const_iterator last) const noexcept;
+
    #pragma endregion
 
    #pragma region Modifiers
 
    using insertion_t = std::pair<iterator, bool>;
 
-   insertion_t emplace  (PayloadT && value);
+   // The payload is constructed once, in place, from the forwarded arguments.
+   template <typename... ArgsT>
+   insertion_t emplace  (ArgsT&&... args);
 
+   // Amortized O(1) when the element belongs immediately before hint; falls back to a full descent otherwise.
    template <typename... ArgsT>
-   insertion_t emplace  (ArgsT&&... args) {return emplace (PayloadT (args...));}
+   iterator    emplace_hint (const_iterator hint, ArgsT&&... args);
+
+   insertion_t insert   (PayloadT const & value) {return emplace (value);}
+
+   insertion_t insert   (PayloadT && value) {return emplace (std::move (value));}
+
+   iterator    insert   (const_iterator hint, PayloadT const & value) {return emplace_hint (hint, value);}
+
+   iterator    insert   (const_iterator hint, PayloadT && value) {return emplace_hint (hint, std::move (value));}
 
    iterator    erase    (iterator position);
    
    void        clear    ();
 
+   // Destroys all elements, tearing the subtrees below the upper levels down on up to
+   // threads threads (0: one per hardware thread).
+   void        clear    (unsigned threads);
+
    const_iterator rotateLeft (const_iterator position);
 
    const_iterator rotateRight (const_iterator position);
 
    #pragma endregion
 
+   #pragma region Join-based bulk operations (tree_options::WeightBalanced only)
+
+   // Appends right, all of whose elements must be greater than this tree's. O(log n).
+   void        join     (BinarySearchTree && right);
+
+   // Moves the elements not less than value into the returned tree. O(log n).
+   BinarySearchTree split (PayloadT const & value);
+
+   // In-place set algebra consuming other; nodes are relinked, never copied. O(m log (n / m + 1))
+   // work for sizes m <= n, recursing on both halves in parallel on up to threads threads
+   // (0: one per hardware thread). With tree_options::Threaded the result is re-threaded
+   // afterwards, which adds O(n + m).
+   void        set_union         (BinarySearchTree && other, unsigned threads = 1);
+
+   void        set_intersection  (BinarySearchTree && other, unsigned threads = 1);
+
+   void        set_difference    (BinarySearchTree && other, unsigned threads = 1);
+
+   #pragma endregion
+
 private:
 
    #pragma region Node declaration / definition
 
-   class Node
+   static constexpr bool f_weightBalanced = HasOption <tree_options::WeightBalanced, OptionsT...>;
+
+   static constexpr bool f_orderStatistics = f_weightBalanced || HasOption <tree_options::OrderStatistics, OptionsT...>;
+
+   static constexpr bool f_threaded = HasOption <tree_options::Threaded, OptionsT...>;
+
+   static constexpr unsigned f_splayPeriod = std::max ({0u, SplayPeriodOf<OptionsT>...});
+
+   static constexpr bool f_splay = f_splayPeriod != 0;
+
+   static_assert ((0 + ... + (SplayPeriodOf<OptionsT> != 0)) <= 1, "at most one splay option can be given");
+
+   static_assert (!(f_splay && f_weightBalanced), "tree_options::Splay and tree_options::WeightBalanced are exclusive");
+
+   class Node : public SubTreeSize <f_orderStatistics>, public InOrderThreads <f_threaded, Node>
    {
    public:
       
       Node () = delete;
-      Node (PayloadT const & value) : i_parent (nullptr), i_left (nullptr), i_right (nullptr), i_value (value) {}
-      Node (PayloadT && value) : i_parent (nullptr), i_left (nullptr), i_right (nullptr), i_value (std::move (value)) {}
+
+      template <typename... ArgsT>
+      explicit Node (std::in_place_t, ArgsT&&... args) : i_parent (nullptr), i_left (nullptr), i_right (nullptr), i_value (std::forward<ArgsT> (args)...) {}
 
       PayloadT const &  value () const {return i_value;}
       PayloadT &        value () {return const_cast<PayloadT &> (const_cast <Node const *> (this)->value ());}
@@ -143,7 +377,7 @@ private:
 
    private:
 
-      friend BinarySearchTree <PayloadT, CompareT>;
+      friend BinarySearchTree <PayloadT, CompareT, OptionsT...>;
 
       void           parent   (Node * node) {i_parent = node;}
       void           left     (Node * node) {i_left = node;}
@@ -189,17 +423,20 @@ private:
 
       iterator_base (iterator_base &&)       = default;
 
+      template <typename U, typename = std::enable_if_t <std::is_same_v <U const, T> && !std::is_same_v <U, T>>>
+      iterator_base (iterator_base <U> const & it) : i_current (it.i_current) {}
+
       ~iterator_base () { i_current = nullptr; }
    
       reference   operator *  () {return i_current->value ();}
 
       pointer     operator->  () {return &(i_current->value ());}
 
-      self_t & operator ++ ()    {auto next = minRightSubTree (i_current); i_current = next ? next : parentOfLeftSubTree (i_current); return *this;}
+      self_t & operator ++ ()    {i_current = successor (i_current); return *this;}
 
       self_t   operator ++ (int) {auto result = *this; ++(*this); return result;}
 
-      self_t & operator -- ()    {auto prev = maxLeftSubTree (i_current); i_current = prev ? prev : parentOfRightSubTree (i_current); return *this;}
+      self_t & operator -- ()    {i_current = predecessor (i_current); return *this;}
 
       self_t   operator -- (int) {auto result = *this; --(*this); return result;}
 
@@ -213,7 +450,33 @@ private:
 
    private:
 
-      friend BinarySearchTree <PayloadT, CompareT>;
+      friend BinarySearchTree <PayloadT, CompareT, OptionsT...>;
+
+      template <typename> friend class iterator_base;
+
+      static node_t * successor (node_t * current)
+      {
+         if constexpr (f_threaded) return current->next ();
+         else return structuralSuccessor (current);
+      }
+
+      static node_t * predecessor (node_t * current)
+      {
+         if constexpr (f_threaded) return current->prev ();
+         else return structuralPredecessor (current);
+      }
+
+      static node_t * structuralSuccessor (node_t * current)
+      {
+         auto next = minRightSubTree (current);
+         return next ? next : parentOfLeftSubTree (current);
+      }
+
+      static node_t * structuralPredecessor (node_t * current)
+      {
+         auto prev = maxLeftSubTree (current);
+         return prev ? prev : parentOfRightSubTree (current);
+      }
 
       template <typename FirstDirectionT, typename SecondDirectionT>
       static node_t * extremeOfSubTree (node_t * current, FirstDirectionT fDirection, SecondDirectionT sDirection)
@@ -276,191 +539,823 @@ private:
 
    #pragma endregion
 
-   static Node *  DeepCopy (Node * root, Node * parent);
+   // Copy and teardown are iterative and use O(1) extra space, whatever the height of the tree.
+   static Node *  DeepCopy (Node const * root, Node * parent);
+
+   static Node *  CopyNode (Node const * source, Node * parent);
+
+   // Builds a balanced subtree from the next count elements of current; recursion depth is log2 (count).
+   template <typename IteratorT>
+   static Node *  BuildBalanced (IteratorT & current, size_type count, Node * parent);
+
+   static Node *  ParallelDeepCopy   (Node const * root, unsigned threads);
+
+   static void    ParallelDeleteTree (Node * root, unsigned threads);
+
+   // Number of subtrees handed out per thread, to even out unbalanced splits.
+   static constexpr unsigned f_subtreesPerThread = 4;
+
+   // Levels the breadth first fan-out may descend below log2 (threads * f_subtreesPerThread) to find
+   // its subtrees; this keeps the fan-out's vectors O(threads) long on degenerate trees.
+   static constexpr unsigned f_fanOutSlack = 4;
+
+   static unsigned FanOutDepth (unsigned threads) noexcept;
+
+   insertion_t    InsertNode     (std::unique_ptr<Node> node);
+
+   iterator       InsertNodeHint (const_iterator hint, std::unique_ptr<Node> node);
+
+   Node *         LinkNode       (std::unique_ptr<Node> node, Node * parent, bool asRight) noexcept;
+
+   Node *         Rightmost      () const noexcept;
+
+   void           ResetExtremes  () noexcept;
+
+   // All descents do a single comparison per level; equality is checked once at the bottom.
+   template <typename KeyT>
+   Node const *   LowerBound  (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   Node const *   UpperBound  (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   Node const *   Find        (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   const_range_t  EqualRange  (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   size_type      Rank        (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   size_type      CountRange  (KeyT const & lo, KeyT const & hi) const noexcept;
+
+   static range_t MakeMutable (const_range_t range) noexcept;
+
+   static size_type  SizeOf      (Node const * node) noexcept;
+
+   static void       UpdateSize  (Node * node) noexcept;
+
+   static void       UpdateSizesToRoot (Node * node) noexcept;
+
+   // Updates sizes from node up to the root, restoring weight balance on the way when enabled.
+   void              RebalanceToRoot (Node * node) noexcept;
+
+   #pragma region Weight balance and join primitives
+
+   // Both sides weigh at least f_alpha of the whole, with weight = size + 1 and f_alpha = 2 / 7,
+   // inside the (2 / 11, 1 - 1 / sqrt (2)) range where single and double rotations suffice.
+   static bool       Balanced    (size_type left, size_type right) noexcept;
+
+   // Local rotations: keep parent links (including the parent's child slot) and sizes right,
+   // return the new subtree root; the tree root is the caller's business.
+   static Node *     RotateLeft  (Node * node) noexcept;
+
+   static Node *     RotateRight (Node * node) noexcept;
+
+   // Rotates node up to the root by zig-zig / zig-zag steps (only with tree_options::Splay),
+   // roughly halving the depth of every node on its access path. Returns node.
+   Node *            Splay       (Node * node) noexcept;
+
+   // Splays the result of every f_splayPeriod-th successful mutable lookup.
+   Node *            SplayLookup (Node * node) noexcept;
+
+   // Restores the balance of node, whose children are balanced; returns the new subtree root.
+   static Node *     Balance     (Node * node) noexcept;
+
+   // Makes key the detached root of left and right.
+   static Node *     MakeNode    (Node * left, Node * key, Node * right) noexcept;
+
+   // Weight balanced union of left, key and right, where left < key < right. Both sides must be
+   // weight balanced: the spine walk relies on it to meet a balanced pair before running out.
+   static Node *     Join        (Node * left, Node * key, Node * right) noexcept;
+
+   static Node *     JoinRight   (Node * left, Node * key, Node * right) noexcept;
+
+   static Node *     JoinLeft    (Node * left, Node * key, Node * right) noexcept;
+
+   // Join without a middle key.
+   static Node *     Join2       (Node * left, Node * right) noexcept;
+
+   struct Split_t
+   {
+      Node * left;
+      Node * match;
+      Node * right;
+   };
+
+   // Splits the detached subtree root around value; match is the detached equivalent node if any.
+   static Split_t    Split       (Node * root, PayloadT const & value) noexcept;
+
+   static Node *     Union        (Node * first, Node * second, unsigned threads);
+
+   static Node *     Intersection (Node * first, Node * second, unsigned threads);
+
+   static Node *     Difference   (Node * first, Node * second, unsigned threads);
+
+   // Runs both calls, the first on another thread when there is a spare thread and enough work.
+   template <typename LeftT, typename RightT>
+   static void       ForkJoin     (unsigned threads, size_type work, LeftT left, RightT right);
+
+   // Below this many elements a subproblem is not worth a thread.
+   static constexpr size_type f_parallelGrain = 1 << 14;
+
+   void              AdoptRoot    (Node * root);
+
+   // As AdoptRoot, for a root whose in-order threads are already right and whose extremes are known.
+   void              AdoptRoot    (Node * root, Node * leftmost, Node * rightmost) noexcept;
+
+   #pragma endregion
+
+   static size_type  IndexOf     (Node const * node, Node const * root) noexcept;
 
    static void    DeleteTree (Node * root);
 
    static const CompareT f_compare;
 
-   Node * i_root;
+   Node *      i_root;
+   Node *      i_leftmost;
+   Node *      i_rightmost;
+   size_type   i_size;
+   unsigned    i_lookups = 0;
 };
 
-template < typename PayloadT, typename CompareT >
-const CompareT BinarySearchTree <PayloadT, CompareT>::f_compare {};
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+const CompareT BinarySearchTree <PayloadT, CompareT, OptionsT...>::f_compare {};
 
-template < typename PayloadT, typename CompareT >
-BinarySearchTree <PayloadT, CompareT>::BinarySearchTree ()
-: i_root (nullptr)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::BinarySearchTree ()
+: i_root (nullptr), i_leftmost (nullptr), i_rightmost (nullptr), i_size (0)
 {
 }
 
-template < typename PayloadT, typename CompareT >
-BinarySearchTree <PayloadT, CompareT>::BinarySearchTree (BinarySearchTree const & tree)
-: i_root (DeepCopy (tree.i_root, nullptr))
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::BinarySearchTree (BinarySearchTree const & tree)
+: i_root (DeepCopy (tree.i_root, nullptr)), i_leftmost (nullptr), i_rightmost (nullptr), i_size (tree.i_size)
 {
+   ResetExtremes ();
 }
 
-template < typename PayloadT, typename CompareT >
-BinarySearchTree <PayloadT, CompareT>::BinarySearchTree (BinarySearchTree && tree)
-: i_root (tree.i_root)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::BinarySearchTree (BinarySearchTree const & tree, unsigned threads)
+: i_root (ParallelDeepCopy (tree.i_root, threads)), i_leftmost (nullptr), i_rightmost (nullptr), i_size (tree.i_size)
 {
-   tree.i_root = nullptr;
+   ResetExtremes ();
 }
 
-template < typename PayloadT, typename CompareT >
-BinarySearchTree <PayloadT, CompareT>::BinarySearchTree (std::initializer_list<PayloadT> && Values)
-: i_root (nullptr)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::BinarySearchTree (BinarySearchTree && tree)
+: i_root (tree.i_root), i_leftmost (tree.i_leftmost), i_rightmost (tree.i_rightmost), i_size (tree.i_size)
 {
-   for (auto && V : Values)
+   tree.i_root = tree.i_leftmost = tree.i_rightmost = nullptr;
+   tree.i_size = 0;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::BinarySearchTree (std::initializer_list<PayloadT> && Values)
+: i_root (nullptr), i_leftmost (nullptr), i_rightmost (nullptr), i_size (0)
+{
+   for (auto const & V : Values)
    {
-      emplace (V);
+      emplace_hint (cend (), V);
    }
 }
 
-template < typename PayloadT, typename CompareT >
-BinarySearchTree <PayloadT, CompareT>::~BinarySearchTree ()
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename IteratorT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::BinarySearchTree (sorted_unique_t, IteratorT first, IteratorT last)
+: i_root (nullptr), i_leftmost (nullptr), i_rightmost (nullptr), i_size (static_cast<size_type> (std::distance (first, last)))
+{
+   i_root = BuildBalanced (first, i_size, nullptr);
+
+   ResetExtremes ();
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree <PayloadT, CompareT, OptionsT...>::~BinarySearchTree ()
 {
    clear ();
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree <PayloadT, CompareT>::Node * BinarySearchTree <PayloadT, CompareT>::DeepCopy (Node * root, Node * parent)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree <PayloadT, CompareT, OptionsT...>::CopyNode (Node const * source, Node * parent)
 {
-   if (!root) return nullptr;
+   auto current = new Node (std::in_place, source->value ());
 
-   auto current = new Node (root->value ());
+   current->parent (parent);
+
+   if constexpr (f_orderStatistics) current->size (source->size ());
 
-   current->parent   (parent);
-   current->left     (DeepCopy (root->left (), current));
-   current->right    (DeepCopy (root->right (), current));
+   return current;
 }
 
-template < typename PayloadT, typename CompareT >
-void BinarySearchTree <PayloadT, CompareT>::DeleteTree (Node * root)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename IteratorT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree <PayloadT, CompareT, OptionsT...>::BuildBalanced (IteratorT & current, size_type count, Node * parent)
 {
-   if (!root) return;
+   if (!count) return nullptr;
 
-   if (root->parent ()) root->parent ()->replaceChild (root, nullptr);
-   root->parent (nullptr);
+   auto leftCount = count / 2;
 
-   DeleteTree (root->left ());
-   DeleteTree (root->right ());
+   auto left = BuildBalanced (current, leftCount, nullptr);
 
-   delete root;
+   auto result = new Node (std::in_place, *current);
+   ++current;
+
+   result->parent (parent);
+   result->left (left);
+   if (left) left->parent (result);
+
+   result->right (BuildBalanced (current, count - leftCount - 1, result));
+
+   if constexpr (f_orderStatistics) result->size (count);
+
+   return result;
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree <PayloadT, CompareT>::const_iterator BinarySearchTree <PayloadT, CompareT>::find (PayloadT const & value) const noexcept
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree <PayloadT, CompareT, OptionsT...>::DeepCopy (Node const * root, Node * parent)
 {
-   auto current = i_root;
+   if (!root) return nullptr;
+
+   // Pre-order walk of the source driven by its parent links; a missing child in the copy
+   // tells whether that side has been visited yet.
+   auto result = CopyNode (root, parent);
 
-   while (current && (f_compare (current->value (), value) || (f_compare (value, current->value ()))))
+   auto source = root;
+   auto current = result;
+
+   while (true)
    {
-      current = f_compare (current->value (), value) ? current->right () : current->left ();
+      if (source->left () && !current->left ())
+      {
+         source = source->left ();
+         current->left (CopyNode (source, current));
+         current = current->left ();
+      }
+      else if (source->right () && !current->right ())
+      {
+         source = source->right ();
+         current->right (CopyNode (source, current));
+         current = current->right ();
+      }
+      else if (source != root)
+      {
+         source = source->parent ();
+         current = current->parent ();
+      }
+      else
+      {
+         break;
+      }
    }
 
-   return const_iterator (current);
+   return result;
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree <PayloadT, CompareT>::iterator BinarySearchTree <PayloadT, CompareT>::find (PayloadT const & value) noexcept
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree <PayloadT, CompareT, OptionsT...>::DeleteTree (Node * root)
 {
-   auto it = const_cast<Self_t const *>(this)->find (value);
+   if (!root) return;
 
-   return iterator (const_cast<Node *> (it.i_current));
-}
+   if (root->parent ()) root->parent ()->replaceChild (root, nullptr);
 
-template < typename PayloadT, typename CompareT >
-bool BinarySearchTree <PayloadT, CompareT>::empty () const noexcept
-{
-   return i_root == nullptr;
+   // Right rotations flatten the tree into a right spine that is freed as it is walked.
+   // Parent links are not maintained: nothing reads them any more.
+   while (root)
+   {
+      if (auto left = root->left ())
+      {
+         root->left (left->right ());
+         left->right (root);
+         root = left;
+      }
+      else
+      {
+         auto right = root->right ();
+         delete root;
+         root = right;
+      }
+   }
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::insertion_t BinarySearchTree<PayloadT, CompareT>::emplace (PayloadT && value)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree <PayloadT, CompareT, OptionsT...>::ParallelDeepCopy (Node const * root, unsigned threads)
 {
-   Node * parent = nullptr;
-   Node * current = i_root;
+   if (!threads) threads = std::max (1u, std::thread::hardware_concurrency ());
+
+   if (!root || threads == 1) return DeepCopy (root, nullptr);
 
-   while (current && (f_compare (current->value (), value) || (f_compare (value, current->value ()))))
+   // Copy the upper levels breadth first until there are enough pending subtrees to share out,
+   // or until the fan-out depth is reached.
+   struct Pending
    {
-      parent = current;
-      current = f_compare (current->value (), value) ? current->right () : current->left ();
-   }
+      Node const *   source;
+      Node *         parent;
+      bool           right;
+      unsigned       depth;
+   };
 
-   if (current) return make_pair (iterator (current), false);
+   auto const maxDepth = FanOutDepth (threads);
 
-   current = new Node (std::move (value));
+   std::vector<Pending> pending {{root, nullptr, false, 0}};
+   Node * result = nullptr;
 
-   current->parent (parent);
+   for (std::size_t next = 0; next < pending.size () && pending.size () - next < threads * f_subtreesPerThread && pending [next].depth < maxDepth; ++next)
+   {
+      auto item = pending [next];
+      auto current = CopyNode (item.source, item.parent);
 
-   auto result = make_pair (iterator (current), true);
+      if (!item.parent) result = current;
+      else if (item.right) item.parent->right (current);
+      else item.parent->left (current);
 
-   if (!parent)
-   {
-      i_root = current;
+      if (item.source->left ()) pending.push_back ({item.source->left (), current, false, item.depth + 1});
+      if (item.source->right ()) pending.push_back ({item.source->right (), current, true, item.depth + 1});
 
-      return result;
+      pending [next].source = nullptr;
    }
 
-   if (f_compare (parent->value (), value))
+   pending.erase (std::remove_if (pending.begin (), pending.end (), [] (Pending const & item) {return !item.source;}), pending.end ());
+
+   // Too lopsided to share out: copy what is left on this thread.
+   if (pending.size () < threads)
    {
-      parent->right (current);
+      for (auto const & item : pending)
+      {
+         auto current = DeepCopy (item.source, item.parent);
+
+         if (!item.parent) result = current;
+         else if (item.right) item.parent->right (current);
+         else item.parent->left (current);
+      }
+
+      return result;
    }
-   else
+
+   std::vector<std::future<void>> tasks;
+
+   for (unsigned thread = 0; thread < threads && thread < pending.size (); ++thread)
    {
-      parent->left (current);
+      tasks.push_back (std::async (std::launch::async, [&pending, thread, threads] ()
+      {
+         // Each task writes only into the child slots of its own subtrees' parents.
+         for (auto index = thread; index < pending.size (); index += threads)
+         {
+            auto & item = pending [index];
+            auto current = DeepCopy (item.source, item.parent);
+
+            if (item.right) item.parent->right (current);
+            else item.parent->left (current);
+         }
+      }));
    }
 
+   for (auto & task : tasks) task.get ();
+
    return result;
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::iterator BinarySearchTree<PayloadT, CompareT>::erase (iterator it)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+unsigned BinarySearchTree <PayloadT, CompareT, OptionsT...>::FanOutDepth (unsigned threads) noexcept
 {
-   auto current = it.i_current;
+   unsigned depth = f_fanOutSlack;
 
-   iterator result = iterator (current);
+   for (auto subtrees = threads * f_subtreesPerThread; subtrees > 1; subtrees /= 2) ++depth;
 
-   if (!current) return result;
+   return depth;
+}
 
-   if (i_root == current) i_root = nullptr;
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree <PayloadT, CompareT, OptionsT...>::ParallelDeleteTree (Node * root, unsigned threads)
+{
+   if (!threads) threads = std::max (1u, std::thread::hardware_concurrency ());
 
-   ++result;
+   if (!root || threads == 1) return DeleteTree (root);
 
-   if (current->left () && current->right ())
+   if (root->parent ()) root->parent ()->replaceChild (root, nullptr);
+
+   // Detach the upper levels breadth first until there are enough subtrees to share out, or until
+   // the fan-out depth is reached.
+   struct Pending
    {
-      current->swap (result.i_current);
+      Node *         node;
+      unsigned       depth;
+   };
 
-      if (!i_root) i_root = result.i_current;
-   }
+   auto const maxDepth = FanOutDepth (threads);
 
-   auto child = current->left () ? current->left () : current->right ();
+   std::vector<Node *> upper;
+   std::vector<Pending> pending {{root, 0}};
 
-   if (!i_root) i_root = child;
+   for (std::size_t next = 0; next < pending.size () && pending.size () - next < threads * f_subtreesPerThread && pending [next].depth < maxDepth; ++next)
+   {
+      auto item = pending [next];
 
-   if (current->parent ()) current->parent ()->replaceChild (current, child);
-   if (child) child->parent (current->parent ());
+      if (item.node->left ()) pending.push_back ({item.node->left (), item.depth + 1});
+      if (item.node->right ()) pending.push_back ({item.node->right (), item.depth + 1});
 
-   current->parent (nullptr);
-   current->left (nullptr);
-   current->right (nullptr);
+      upper.push_back (item.node);
+      pending [next].node = nullptr;
+   }
 
-   delete current;
+   for (auto current : upper)
+   {
+      current->left (nullptr);
+      current->right (nullptr);
+      delete current;
+   }
 
-   return result;
-}
+   std::vector<Node *> subtrees;
 
-template < typename PayloadT, typename CompareT >
-void BinarySearchTree<PayloadT, CompareT>::clear ()
-{
-   DeleteTree (i_root);
+   for (auto const & item : pending)
+   {
+      if (item.node) subtrees.push_back (item.node);
+   }
+
+   // Too lopsided to share out: tear what is left down on this thread.
+   if (subtrees.size () < threads)
+   {
+      for (auto subtree : subtrees)
+      {
+         subtree->parent (nullptr);
+         DeleteTree (subtree);
+      }
+
+      return;
+   }
+
+   std::vector<std::future<void>> tasks;
+
+   for (unsigned thread = 0; thread < threads && thread < subtrees.size (); ++thread)
+   {
+      tasks.push_back (std::async (std::launch::async, [&subtrees, thread, threads] ()
+      {
+         for (auto index = thread; index < subtrees.size (); index += threads)
+         {
+            subtrees [index]->parent (nullptr);
+            DeleteTree (subtrees [index]);
+         }
+      }));
+   }
+
+   for (auto & task : tasks) task.get ();
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename KeyT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node const * BinarySearchTree <PayloadT, CompareT, OptionsT...>::LowerBound (KeyT const & key) const noexcept
+{
+   Node const * result = nullptr;
+   Node const * current = i_root;
+
+   while (current)
+   {
+      bool const less = f_compare (current->value (), key);
+
+      result  = less ? result : current;
+      current = less ? current->right () : current->left ();
+   }
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename KeyT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node const * BinarySearchTree <PayloadT, CompareT, OptionsT...>::UpperBound (KeyT const & key) const noexcept
+{
+   Node const * result = nullptr;
+   Node const * current = i_root;
+
+   while (current)
+   {
+      bool const greater = f_compare (key, current->value ());
+
+      result  = greater ? current : result;
+      current = greater ? current->left () : current->right ();
+   }
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename KeyT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::Node const * BinarySearchTree <PayloadT, CompareT, OptionsT...>::Find (KeyT const & key) const noexcept
+{
+   auto result = LowerBound (key);
+
+   return result && !f_compare (key, result->value ()) ? result : nullptr;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename KeyT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::const_range_t BinarySearchTree <PayloadT, CompareT, OptionsT...>::EqualRange (KeyT const & key) const noexcept
+{
+   auto first = const_iterator (LowerBound (key));
+
+   if (first == cend () || f_compare (key, *first)) return const_range_t (first, first);
+
+   return const_range_t (first, std::next (first));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::range_t BinarySearchTree <PayloadT, CompareT, OptionsT...>::MakeMutable (const_range_t range) noexcept
+{
+   return range_t (iterator (const_cast<Node *> (range.first.i_current)), iterator (const_cast<Node *> (range.second.i_current)));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree <PayloadT, CompareT, OptionsT...>::find (PayloadT const & value) const noexcept
+{
+   return const_iterator (Find (value));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree <PayloadT, CompareT, OptionsT...>::find (PayloadT const & value) noexcept
+{
+   return iterator (SplayLookup (const_cast<Node *> (Find (value))));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree <PayloadT, CompareT, OptionsT...>::lower_bound (PayloadT const & value) const noexcept
+{
+   return const_iterator (LowerBound (value));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree <PayloadT, CompareT, OptionsT...>::lower_bound (PayloadT const & value) noexcept
+{
+   return iterator (const_cast<Node *> (LowerBound (value)));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree <PayloadT, CompareT, OptionsT...>::upper_bound (PayloadT const & value) const noexcept
+{
+   return const_iterator (UpperBound (value));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree <PayloadT, CompareT, OptionsT...>::upper_bound (PayloadT const & value) noexcept
+{
+   return iterator (const_cast<Node *> (UpperBound (value)));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::const_range_t BinarySearchTree <PayloadT, CompareT, OptionsT...>::equal_range (PayloadT const & value) const noexcept
+{
+   return EqualRange (value);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::range_t BinarySearchTree <PayloadT, CompareT, OptionsT...>::equal_range (PayloadT const & value) noexcept
+{
+   return MakeMutable (EqualRange (value));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+bool BinarySearchTree <PayloadT, CompareT, OptionsT...>::empty () const noexcept
+{
+   return i_root == nullptr;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree <PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree <PayloadT, CompareT, OptionsT...>::size () const noexcept
+{
+   return i_size;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename... ArgsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::insertion_t BinarySearchTree<PayloadT, CompareT, OptionsT...>::emplace (ArgsT&&... args)
+{
+   auto result = InsertNode (std::unique_ptr<Node> (new Node (std::in_place, std::forward<ArgsT> (args)...)));
+
+   Splay (result.first.i_current);
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename... ArgsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::emplace_hint (const_iterator hint, ArgsT&&... args)
+{
+   auto result = InsertNodeHint (hint, std::unique_ptr<Node> (new Node (std::in_place, std::forward<ArgsT> (args)...)));
+
+   Splay (result.i_current);
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::insertion_t BinarySearchTree<PayloadT, CompareT, OptionsT...>::InsertNode (std::unique_ptr<Node> node)
+{
+   auto const & value = node->value ();
+
+   Node * parent = nullptr;
+   Node * current = i_root;
+   Node * candidate = nullptr;
+   bool   less = false;
+
+   while (current)
+   {
+      parent = current;
+      less = f_compare (current->value (), value);
+
+      candidate = less ? candidate : current;
+      current   = less ? current->right () : current->left ();
+   }
+
+   if (candidate && !f_compare (value, candidate->value ())) return make_pair (iterator (candidate), false);
+
+   return make_pair (iterator (LinkNode (std::move (node), parent, less)), true);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::InsertNodeHint (const_iterator hint, std::unique_ptr<Node> node)
+{
+   auto const & value = node->value ();
+
+   auto next = const_cast<Node *> (hint.i_current);
+
+   if (!next)
+   {
+      auto last = Rightmost ();
+
+      if (!last || f_compare (last->value (), value)) return iterator (LinkNode (std::move (node), last, true));
+
+      return InsertNode (std::move (node)).first;
+   }
+
+   if (!f_compare (value, next->value ()))
+   {
+      if (!f_compare (next->value (), value)) return iterator (next);
+
+      return InsertNode (std::move (node)).first;
+   }
+
+   auto prev = --iterator (next);
+
+   if (prev.i_current && !f_compare (prev.i_current->value (), value))
+   {
+      return InsertNode (std::move (node)).first;
+   }
+
+   // value fits between prev and next: next has a free left slot unless it has a left subtree,
+   // in which case prev is that subtree's maximum and has a free right slot.
+   if (!next->left ()) return iterator (LinkNode (std::move (node), next, false));
+
+   return iterator (LinkNode (std::move (node), prev.i_current, true));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::LinkNode (std::unique_ptr<Node> node, Node * parent, bool asRight) noexcept
+{
+   auto current = node.release ();
+
+   current->parent (parent);
+
+   ++i_size;
 
-   i_root = nullptr;
+   if (!parent)
+   {
+      i_root = i_leftmost = i_rightmost = current;
+
+      return current;
+   }
+
+   if (asRight)
+   {
+      parent->right (current);
+
+      if (parent == i_rightmost) i_rightmost = current;
+
+      if constexpr (f_threaded)
+      {
+         current->prev (parent);
+         current->next (parent->next ());
+      }
+   }
+   else
+   {
+      parent->left (current);
+
+      if (parent == i_leftmost) i_leftmost = current;
+
+      if constexpr (f_threaded)
+      {
+         current->prev (parent->prev ());
+         current->next (parent);
+      }
+   }
+
+   if constexpr (f_threaded)
+   {
+      if (current->prev ()) current->prev ()->next (current);
+      if (current->next ()) current->next ()->prev (current);
+   }
+
+   RebalanceToRoot (parent);
+
+   return current;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Rightmost () const noexcept
+{
+   return i_rightmost;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::ResetExtremes () noexcept
+{
+   i_leftmost = i_rightmost = i_root;
+
+   while (i_leftmost && i_leftmost->left ()) i_leftmost = i_leftmost->left ();
+   while (i_rightmost && i_rightmost->right ()) i_rightmost = i_rightmost->right ();
+
+   if constexpr (f_threaded)
+   {
+      Node * prev = nullptr;
+
+      for (auto current = i_leftmost; current; prev = current, current = iterator::structuralSuccessor (current))
+      {
+         current->prev (prev);
+         if (prev) prev->next (current);
+      }
+
+      if (i_rightmost) i_rightmost->next (nullptr);
+   }
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::erase (iterator it)
+{
+   auto current = it.i_current;
+
+   iterator result = iterator (current);
+
+   if (!current) return result;
+
+   if (i_root == current) i_root = nullptr;
+
+   ++result;
+
+   --i_size;
+
+   if (current == i_leftmost) i_leftmost = result.i_current;
+   if (current == i_rightmost) i_rightmost = iterator::predecessor (current);
+
+   if constexpr (f_threaded)
+   {
+      if (current->prev ()) current->prev ()->next (current->next ());
+      if (current->next ()) current->next ()->prev (current->prev ());
+   }
+
+   if (current->left () && current->right ())
+   {
+      current->swap (result.i_current);
+
+      if (!i_root) i_root = result.i_current;
+   }
+
+   auto child = current->left () ? current->left () : current->right ();
+
+   if (!i_root) i_root = child;
+
+   if (current->parent ()) current->parent ()->replaceChild (current, child);
+   if (child) child->parent (current->parent ());
+
+   RebalanceToRoot (current->parent ());
+
+   current->parent (nullptr);
+   current->left (nullptr);
+   current->right (nullptr);
+
+   delete current;
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::clear ()
+{
+   DeleteTree (i_root);
+
+   i_root = i_leftmost = i_rightmost = nullptr;
+   i_size = 0;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::clear (unsigned threads)
+{
+   ParallelDeleteTree (i_root, threads);
+
+   i_root = i_leftmost = i_rightmost = nullptr;
+   i_size = 0;
 }
 
-template < typename PayloadT, typename CompareT >
-void BinarySearchTree<PayloadT, CompareT>::Node::swap (Node * other)
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node::swap (Node * other)
 {
    if (!other)
    {
@@ -479,46 +1374,728 @@ void BinarySearchTree<PayloadT, CompareT>::Node::swap (Node * other)
    if (i_right) i_right->parent (other);
    if (other->i_right) other->i_right->parent (this);
    std::swap (i_right, other->i_right);
+
+   if constexpr (f_orderStatistics)
+   {
+      auto size = this->size ();
+      this->size (other->size ());
+      other->size (size);
+   }
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::const_iterator BinarySearchTree<PayloadT, CompareT>::begin () const
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::rotateLeft (const_iterator position)
 {
-   return cbegin ();
+   auto current = const_cast<Node *> (position.i_current);
+
+   if (!current || !current->right ()) return position;
+
+   auto pivot = RotateLeft (current);
+
+   if (!pivot->parent ()) i_root = pivot;
+
+   return const_iterator (pivot);
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::const_iterator BinarySearchTree<PayloadT, CompareT>::cbegin () const
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::rotateRight (const_iterator position)
 {
-   auto current = i_root;
+   auto current = const_cast<Node *> (position.i_current);
 
-   while (current && current->left ()) current = current->left ();
+   if (!current || !current->left ()) return position;
 
-   return const_iterator (current);
+   auto pivot = RotateRight (current);
+
+   if (!pivot->parent ()) i_root = pivot;
+
+   return const_iterator (pivot);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::RotateLeft (Node * node) noexcept
+{
+   auto pivot = node->right ();
+   auto parent = node->parent ();
+
+   node->right (pivot->left ());
+   if (pivot->left ()) pivot->left ()->parent (node);
+
+   pivot->left (node);
+   node->parent (pivot);
+
+   pivot->parent (parent);
+   if (parent) parent->replaceChild (node, pivot);
+
+   UpdateSize (node);
+   UpdateSize (pivot);
+
+   return pivot;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::RotateRight (Node * node) noexcept
+{
+   auto pivot = node->left ();
+   auto parent = node->parent ();
+
+   node->left (pivot->right ());
+   if (pivot->right ()) pivot->right ()->parent (node);
+
+   pivot->right (node);
+   node->parent (pivot);
+
+   pivot->parent (parent);
+   if (parent) parent->replaceChild (node, pivot);
+
+   UpdateSize (node);
+   UpdateSize (pivot);
+
+   return pivot;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Splay (Node * node) noexcept
+{
+   if constexpr (f_splay)
+   {
+      if (!node) return node;
+
+      while (auto parent = node->parent ())
+      {
+         auto grandParent = parent->parent ();
+         bool const leftChild = node == parent->left ();
+
+         if (!grandParent)
+         {
+            leftChild ? RotateRight (parent) : RotateLeft (parent);
+         }
+         else if (leftChild == (parent == grandParent->left ()))
+         {
+            // zig-zig: the grandparent goes first, which is what shortens the path.
+            leftChild ? RotateRight (grandParent) : RotateLeft (grandParent);
+            leftChild ? RotateRight (parent) : RotateLeft (parent);
+         }
+         else
+         {
+            leftChild ? RotateRight (parent) : RotateLeft (parent);
+            leftChild ? RotateLeft (grandParent) : RotateRight (grandParent);
+         }
+      }
+
+      i_root = node;
+   }
+
+   return node;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::SplayLookup (Node * node) noexcept
+{
+   if constexpr (f_splay)
+   {
+      if constexpr (f_splayPeriod == 1) Splay (node);
+      else if (node && ++i_lookups % f_splayPeriod == 0) Splay (node);
+   }
+
+   return node;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+bool BinarySearchTree<PayloadT, CompareT, OptionsT...>::Balanced (size_type left, size_type right) noexcept
+{
+   auto const leftWeight = left + 1;
+   auto const rightWeight = right + 1;
+
+   return 7 * std::min (leftWeight, rightWeight) >= 2 * (leftWeight + rightWeight);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Balance (Node * node) noexcept
+{
+   auto const leftSize = SizeOf (node->left ());
+   auto const rightSize = SizeOf (node->right ());
+
+   if (Balanced (leftSize, rightSize)) return node;
+
+   if (rightSize > leftSize)
+   {
+      auto heavy = node->right ();
+
+      // A single rotation when it balances both nodes it touches, a double one otherwise.
+      if (heavy->left () && (!Balanced (leftSize, SizeOf (heavy->left ())) || !Balanced (leftSize + SizeOf (heavy->left ()) + 1, SizeOf (heavy->right ()))))
+      {
+         RotateRight (heavy);
+      }
+
+      return RotateLeft (node);
+   }
+
+   auto heavy = node->left ();
+
+   if (heavy->right () && (!Balanced (SizeOf (heavy->right ()), rightSize) || !Balanced (SizeOf (heavy->left ()), SizeOf (heavy->right ()) + rightSize + 1)))
+   {
+      RotateLeft (heavy);
+   }
+
+   return RotateRight (node);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::RebalanceToRoot (Node * node) noexcept
+{
+   if constexpr (f_weightBalanced)
+   {
+      for (; node; node = node->parent ())
+      {
+         UpdateSize (node);
+
+         node = Balance (node);
+
+         if (!node->parent ()) i_root = node;
+      }
+   }
+   else
+   {
+      UpdateSizesToRoot (node);
+   }
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::MakeNode (Node * left, Node * key, Node * right) noexcept
+{
+   key->parent (nullptr);
+
+   key->left (left);
+   if (left) left->parent (key);
+
+   key->right (right);
+   if (right) right->parent (key);
+
+   UpdateSize (key);
+
+   return key;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::JoinRight (Node * left, Node * key, Node * right) noexcept
+{
+   if (Balanced (SizeOf (left), SizeOf (right))) return MakeNode (left, key, right);
+
+   // left is the heavier side: join into its right spine, then fix the balance on the way back up.
+   auto joined = JoinRight (left->right (), key, right);
+
+   return Balance (MakeNode (left->left (), left, joined));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::JoinLeft (Node * left, Node * key, Node * right) noexcept
+{
+   if (Balanced (SizeOf (left), SizeOf (right))) return MakeNode (left, key, right);
+
+   auto joined = JoinLeft (left, key, right->left ());
+
+   return Balance (MakeNode (joined, right, right->right ()));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Join (Node * left, Node * key, Node * right) noexcept
+{
+   auto const leftSize = SizeOf (left);
+   auto const rightSize = SizeOf (right);
+
+   if (Balanced (leftSize, rightSize)) return MakeNode (left, key, right);
+
+   return leftSize > rightSize ? JoinRight (left, key, right) : JoinLeft (left, key, right);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Join2 (Node * left, Node * right) noexcept
+{
+   if (!left) return right;
+   if (!right) return left;
+
+   // Take the smallest node of right out as the middle key.
+   auto key = right;
+   while (key->left ()) key = key->left ();
+
+   auto parent = key->parent ();
+   auto rest = key->right ();
+
+   if (parent)
+   {
+      parent->left (rest);
+      if (rest) rest->parent (parent);
+
+      for (auto node = parent; node; node = node->parent ()) UpdateSize (node);
+
+      // Removing one node can unbalance each ancestor on the left spine; rebalance bottom up.
+      for (auto node = parent; node;)
+      {
+         auto balanced = Balance (node);
+         node = balanced->parent ();
+         if (!node) right = balanced;
+      }
+   }
+   else
+   {
+      right = rest;
+   }
+
+   if (right) right->parent (nullptr);
+
+   return Join (left, key, right);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Split_t BinarySearchTree<PayloadT, CompareT, OptionsT...>::Split (Node * root, PayloadT const & value) noexcept
+{
+   if (!root) return {nullptr, nullptr, nullptr};
+
+   auto left = root->left ();
+   auto right = root->right ();
+
+   if (left) left->parent (nullptr);
+   if (right) right->parent (nullptr);
+
+   if (f_compare (value, root->value ()))
+   {
+      auto result = Split (left, value);
+      result.right = Join (result.right, root, right);
+      return result;
+   }
+
+   if (f_compare (root->value (), value))
+   {
+      auto result = Split (right, value);
+      result.left = Join (left, root, result.left);
+      return result;
+   }
+
+   return {left, MakeNode (nullptr, root, nullptr), right};
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename LeftT, typename RightT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::ForkJoin (unsigned threads, size_type work, LeftT left, RightT right)
+{
+   if (threads < 2 || work < f_parallelGrain)
+   {
+      left (1);
+      right (1);
+      return;
+   }
+
+   auto task = std::async (std::launch::async, left, threads / 2);
+
+   right (threads - threads / 2);
+
+   task.get ();
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Union (Node * first, Node * second, unsigned threads)
+{
+   if (!first) return second;
+   if (!second) return first;
+
+   auto const work = SizeOf (first) + SizeOf (second);
+
+   auto split = Split (second, first->value ());
+
+   delete split.match;
+
+   auto left = first->left ();
+   auto right = first->right ();
+
+   if (left) left->parent (nullptr);
+   if (right) right->parent (nullptr);
+
+   ForkJoin (threads, work,
+             [&] (unsigned budget) {left = Union (left, split.left, budget);},
+             [&] (unsigned budget) {right = Union (right, split.right, budget);});
+
+   return Join (left, first, right);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Intersection (Node * first, Node * second, unsigned threads)
+{
+   if (!first || !second)
+   {
+      DeleteTree (first);
+      DeleteTree (second);
+      return nullptr;
+   }
+
+   auto const work = SizeOf (first) + SizeOf (second);
+
+   auto split = Split (second, first->value ());
+
+   auto left = first->left ();
+   auto right = first->right ();
+
+   if (left) left->parent (nullptr);
+   if (right) right->parent (nullptr);
+
+   ForkJoin (threads, work,
+             [&] (unsigned budget) {left = Intersection (left, split.left, budget);},
+             [&] (unsigned budget) {right = Intersection (right, split.right, budget);});
+
+   if (split.match)
+   {
+      delete split.match;
+      return Join (left, first, right);
+   }
+
+   first->left (nullptr);
+   first->right (nullptr);
+   delete first;
+
+   return Join2 (left, right);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::Node * BinarySearchTree<PayloadT, CompareT, OptionsT...>::Difference (Node * first, Node * second, unsigned threads)
+{
+   if (!first || !second)
+   {
+      DeleteTree (second);
+      return first;
+   }
+
+   auto const work = SizeOf (first) + SizeOf (second);
+
+   // Split first around the root of second, which is dropped together with its match.
+   auto split = Split (first, second->value ());
+
+   auto left = second->left ();
+   auto right = second->right ();
+
+   if (left) left->parent (nullptr);
+   if (right) right->parent (nullptr);
+
+   second->left (nullptr);
+   second->right (nullptr);
+   delete second;
+   delete split.match;
+
+   ForkJoin (threads, work,
+             [&] (unsigned budget) {left = Difference (split.left, left, budget);},
+             [&] (unsigned budget) {right = Difference (split.right, right, budget);});
+
+   return Join2 (left, right);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::AdoptRoot (Node * root)
+{
+   i_root = root;
+
+   if (i_root) i_root->parent (nullptr);
+
+   i_size = SizeOf (i_root);
+
+   ResetExtremes ();
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::AdoptRoot (Node * root, Node * leftmost, Node * rightmost) noexcept
+{
+   i_root = root;
+
+   if (i_root) i_root->parent (nullptr);
+
+   i_size = SizeOf (i_root);
+
+   i_leftmost = leftmost;
+   i_rightmost = rightmost;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::join (BinarySearchTree && right)
+{
+   static_assert (f_weightBalanced, "join requires tree_options::WeightBalanced");
+
+   // Only the seam between the two in-order sequences changes.
+   auto const leftLast = i_rightmost;
+   auto const rightFirst = right.i_leftmost;
+
+   auto const leftmost = i_leftmost ? i_leftmost : right.i_leftmost;
+   auto const rightmost = right.i_rightmost ? right.i_rightmost : i_rightmost;
+
+   auto root = Join2 (i_root, right.i_root);
+
+   right.i_root = right.i_leftmost = right.i_rightmost = nullptr;
+   right.i_size = 0;
+
+   if constexpr (f_threaded)
+   {
+      if (leftLast && rightFirst)
+      {
+         leftLast->next (rightFirst);
+         rightFirst->prev (leftLast);
+      }
+   }
+
+   AdoptRoot (root, leftmost, rightmost);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+BinarySearchTree<PayloadT, CompareT, OptionsT...> BinarySearchTree<PayloadT, CompareT, OptionsT...>::split (PayloadT const & value)
+{
+   static_assert (f_weightBalanced, "split requires tree_options::WeightBalanced");
+
+   // The cut falls between lowerLast and upperFirst, either of which may be missing.
+   auto const leftmost = i_leftmost;
+   auto const rightmost = i_rightmost;
+
+   auto const upperFirst = const_cast<Node *> (LowerBound (value));
+   auto const lowerLast = !upperFirst ? rightmost : upperFirst == leftmost ? nullptr : (--iterator (upperFirst)).i_current;
+
+   auto parts = Split (i_root, value);
+
+   if constexpr (f_threaded)
+   {
+      if (lowerLast && upperFirst)
+      {
+         lowerLast->next (nullptr);
+         upperFirst->prev (nullptr);
+      }
+   }
+
+   BinarySearchTree result;
+
+   result.AdoptRoot (parts.match ? Join (nullptr, parts.match, parts.right) : parts.right, upperFirst, upperFirst ? rightmost : nullptr);
+
+   AdoptRoot (parts.left, lowerLast ? leftmost : nullptr, lowerLast);
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::set_union (BinarySearchTree && other, unsigned threads)
+{
+   static_assert (f_weightBalanced, "set_union requires tree_options::WeightBalanced");
+
+   if (!threads) threads = std::max (1u, std::thread::hardware_concurrency ());
+
+   auto root = Union (i_root, other.i_root, threads);
+
+   other.i_root = other.i_leftmost = other.i_rightmost = nullptr;
+   other.i_size = 0;
+
+   AdoptRoot (root);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::set_intersection (BinarySearchTree && other, unsigned threads)
+{
+   static_assert (f_weightBalanced, "set_intersection requires tree_options::WeightBalanced");
+
+   if (!threads) threads = std::max (1u, std::thread::hardware_concurrency ());
+
+   auto root = Intersection (i_root, other.i_root, threads);
+
+   other.i_root = other.i_leftmost = other.i_rightmost = nullptr;
+   other.i_size = 0;
+
+   AdoptRoot (root);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::set_difference (BinarySearchTree && other, unsigned threads)
+{
+   static_assert (f_weightBalanced, "set_difference requires tree_options::WeightBalanced");
+
+   if (!threads) threads = std::max (1u, std::thread::hardware_concurrency ());
+
+   auto root = Difference (i_root, other.i_root, threads);
+
+   other.i_root = other.i_leftmost = other.i_rightmost = nullptr;
+   other.i_size = 0;
+
+   AdoptRoot (root);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::SizeOf (Node const * node) noexcept
+{
+   return node ? node->size () : 0;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::UpdateSize (Node * node) noexcept
+{
+   if constexpr (f_orderStatistics)
+   {
+      if (node) node->size (1 + SizeOf (node->left ()) + SizeOf (node->right ()));
+   }
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+void BinarySearchTree<PayloadT, CompareT, OptionsT...>::UpdateSizesToRoot (Node * node) noexcept
+{
+   if constexpr (f_orderStatistics)
+   {
+      for (; node; node = node->parent ()) UpdateSize (node);
+   }
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::IndexOf (Node const * node, Node const * root) noexcept
+{
+   static_assert (f_orderStatistics, "IndexOf requires tree_options::OrderStatistics");
+
+   if (!node) return SizeOf (root);
+
+   auto index = SizeOf (node->left ());
+
+   for (auto parent = node->parent (); parent; node = parent, parent = node->parent ())
+   {
+      if (parent->right () == node) index += SizeOf (parent->left ()) + 1;
+   }
+
+   return index;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::rank (PayloadT const & value) const noexcept
+{
+   return Rank (value);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename KeyT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::Rank (KeyT const & key) const noexcept
+{
+   static_assert (f_orderStatistics, "rank requires tree_options::OrderStatistics");
+
+   size_type result = 0;
+
+   for (auto current = i_root; current;)
+   {
+      if (f_compare (current->value (), key))
+      {
+         result += SizeOf (current->left ()) + 1;
+         current = current->right ();
+      }
+      else
+      {
+         current = current->left ();
+      }
+   }
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::select (size_type k) const noexcept
+{
+   static_assert (f_orderStatistics, "select requires tree_options::OrderStatistics");
+
+   auto current = i_root;
+
+   while (current)
+   {
+      auto leftSize = SizeOf (current->left ());
+
+      if (k == leftSize) break;
+
+      if (k < leftSize)
+      {
+         current = current->left ();
+      }
+      else
+      {
+         k -= leftSize + 1;
+         current = current->right ();
+      }
+   }
+
+   return const_iterator (current);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::select (size_type k) noexcept
+{
+   auto it = const_cast<Self_t const *>(this)->select (k);
+
+   return iterator (const_cast<Node *> (it.i_current));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::count_range (PayloadT const & lo, PayloadT const & hi) const noexcept
+{
+   return CountRange (lo, hi);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+template < typename KeyT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::size_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::CountRange (KeyT const & lo, KeyT const & hi) const noexcept
+{
+   if (!f_compare (lo, hi)) return 0;
+
+   return Rank (hi) - Rank (lo);
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::advance (const_iterator it, difference_type n) const noexcept
+{
+   auto index = static_cast<difference_type> (IndexOf (it.i_current, i_root)) + n;
+
+   if (index < 0) return cend ();
+
+   return select (static_cast<size_type> (index));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::advance (iterator it, difference_type n) noexcept
+{
+   auto result = const_cast<Self_t const *>(this)->advance (const_iterator (it.i_current), n);
+
+   return iterator (const_cast<Node *> (result.i_current));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::difference_type BinarySearchTree<PayloadT, CompareT, OptionsT...>::distance (const_iterator first, const_iterator last) const noexcept
+{
+   return static_cast<difference_type> (IndexOf (last.i_current, i_root)) - static_cast<difference_type> (IndexOf (first.i_current, i_root));
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::begin () const
+{
+   return cbegin ();
+}
+
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::cbegin () const
+{
+   return const_iterator (i_leftmost);
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::const_iterator BinarySearchTree<PayloadT, CompareT>::end () const
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::end () const
 {
    return cend ();
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::const_iterator BinarySearchTree<PayloadT, CompareT>::cend () const
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::const_iterator BinarySearchTree<PayloadT, CompareT, OptionsT...>::cend () const
 {
    return const_iterator ();
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::iterator       BinarySearchTree<PayloadT, CompareT>::begin ()
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator       BinarySearchTree<PayloadT, CompareT, OptionsT...>::begin ()
 {
    auto it = const_cast <Self_t const *> (this)->begin ();
    auto current = const_cast<Node *> (it.i_current);
    return iterator (current);
 }
 
-template < typename PayloadT, typename CompareT >
-typename BinarySearchTree<PayloadT, CompareT>::iterator       BinarySearchTree<PayloadT, CompareT>::end ()
+template < typename PayloadT, typename CompareT, typename... OptionsT >
+typename BinarySearchTree<PayloadT, CompareT, OptionsT...>::iterator       BinarySearchTree<PayloadT, CompareT, OptionsT...>::end ()
 {
    return iterator ();
 }
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace utilities
+{
+
+template < typename ValueT, typename CompareT, typename TagT >
+class IntrusiveSearchTree;
+
+// Links embedded in objects stored by an IntrusiveSearchTree: derive from it publicly (once per
+// tree the object may belong to, each with its own TagT). Besides the tree links the hook keeps
+// in-order threads and a pointer back to its tree, which makes iteration a pointer walk and
+// unlink () O(1) from the object alone.
+// Copies of a hook are unlinked; destroying a linked hook unlinks it.
+template <typename TagT = void>
+class IntrusiveTreeHook
+{
+public:
+
+   IntrusiveTreeHook () noexcept = default;
+
+   IntrusiveTreeHook (IntrusiveTreeHook const &) noexcept {}
+
+   IntrusiveTreeHook & operator = (IntrusiveTreeHook const &) noexcept {return *this;}
+
+   ~IntrusiveTreeHook () {unlink ();}
+
+   bool is_linked () const noexcept {return i_header != nullptr;}
+
+   // Removes the object from its tree, if any, without touching any other object's payload.
+   void unlink () noexcept;
+
+private:
+
+   template < typename ValueT, typename CompareT, typename OtherTagT >
+   friend class IntrusiveSearchTree;
+
+   // Per-tree state reachable from every hook; end is the sentinel closing the circular thread
+   // list: end.i_next is the leftmost hook, end.i_prev the rightmost.
+   struct Header;
+
+   IntrusiveTreeHook * i_parent = nullptr;
+   IntrusiveTreeHook * i_left = nullptr;
+   IntrusiveTreeHook * i_right = nullptr;
+   IntrusiveTreeHook * i_prev = nullptr;
+   IntrusiveTreeHook * i_next = nullptr;
+   Header *            i_header = nullptr;
+};
+
+template <typename TagT>
+struct IntrusiveTreeHook <TagT>::Header
+{
+   Header () noexcept {end.i_prev = end.i_next = &end;}
+
+   Header (Header const &) = delete;
+
+   Header & operator = (Header const &) = delete;
+
+   IntrusiveTreeHook    end;
+   IntrusiveTreeHook *  root = nullptr;
+   std::size_t          size = 0;
+};
+
+template <typename TagT>
+void IntrusiveTreeHook <TagT>::unlink () noexcept
+{
+   if (!i_header) return;
+
+   auto const successor = i_next;
+
+   i_prev->i_next = i_next;
+   i_next->i_prev = i_prev;
+
+   // The replacement takes this hook's place: a lone child or, with two children, the in-order
+   // successor, which then is the leftmost hook of the right subtree.
+   IntrusiveTreeHook * replacement = i_left ? i_right ? successor : i_left : i_right;
+
+   if (i_left && i_right)
+   {
+      if (successor != i_right)
+      {
+         successor->i_parent->i_left = successor->i_right;
+         if (successor->i_right) successor->i_right->i_parent = successor->i_parent;
+
+         successor->i_right = i_right;
+         i_right->i_parent = successor;
+      }
+
+      successor->i_left = i_left;
+      i_left->i_parent = successor;
+   }
+
+   if (replacement) replacement->i_parent = i_parent;
+
+   if (!i_parent) i_header->root = replacement;
+   else if (i_parent->i_left == this) i_parent->i_left = replacement;
+   else i_parent->i_right = replacement;
+
+   --i_header->size;
+
+   i_parent = i_left = i_right = i_prev = i_next = nullptr;
+   i_header = nullptr;
+}
+
+// Ordered set of caller-owned objects linked through their IntrusiveTreeHook <TagT> base: insert
+// and erase never allocate, copy or move a payload, and never fail. The container does not own
+// its elements: they must outlive their membership (or unlink themselves on destruction, which the
+// hook does), and must not change their key while linked. Not balanced, like BinarySearchTree
+// without options; objects can leave in O(1) through their hook's unlink ().
+template < typename ValueT, typename CompareT = std::less <ValueT>, typename TagT = void >
+class IntrusiveSearchTree
+{
+   using Hook = IntrusiveTreeHook <TagT>;
+
+   using Header = typename Hook::Header;
+
+   static_assert (std::is_base_of_v <Hook, ValueT>, "ValueT must derive from IntrusiveTreeHook <TagT>");
+
+public:
+
+   using size_type         = std::size_t;
+
+   using difference_type   = std::ptrdiff_t;
+
+   #pragma region Construction, Dectruction, Assignment
+
+   IntrusiveSearchTree () = default;
+
+   // Elements are linked through a header that lives in the container, which therefore stays put.
+   IntrusiveSearchTree (IntrusiveSearchTree const &) = delete;
+
+   IntrusiveSearchTree & operator = (IntrusiveSearchTree const &) = delete;
+
+   // Unlinks the remaining elements.
+   ~IntrusiveSearchTree ();
+
+   #pragma endregion
+
+   #pragma region Iterator
+
+private:
+
+   template <typename T> class iterator_base;
+
+public:
+
+   using const_iterator          = iterator_base <ValueT const>;
+
+   using iterator                = iterator_base <ValueT>;
+
+   using const_reverse_iterator  = std::reverse_iterator <const_iterator>;
+
+   using reverse_iterator        = std::reverse_iterator <iterator>;
+
+   const_iterator          begin    () const noexcept {return const_iterator (i_header.end.i_next);}
+   const_iterator          cbegin   () const noexcept {return begin ();}
+   const_iterator          end      () const noexcept {return const_iterator (&i_header.end);}
+   const_iterator          cend     () const noexcept {return end ();}
+   iterator                begin    () noexcept {return iterator (i_header.end.i_next);}
+   iterator                end      () noexcept {return iterator (&i_header.end);}
+
+   const_reverse_iterator  rbegin   () const noexcept {return const_reverse_iterator (end ());}
+   const_reverse_iterator  rend     () const noexcept {return const_reverse_iterator (begin ());}
+   reverse_iterator        rbegin   () noexcept {return reverse_iterator (end ());}
+   reverse_iterator        rend     () noexcept {return reverse_iterator (begin ());}
+
+   // Iterator to an element linked into some IntrusiveSearchTree <ValueT, CompareT, TagT>.
+   static iterator         iterator_to (ValueT & value) noexcept {return iterator (HookOf (&value));}
+
+   static const_iterator   iterator_to (ValueT const & value) noexcept {return const_iterator (HookOf (&value));}
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   const_iterator find        (ValueT const & value) const noexcept {return const_iterator (Find (value));}
+
+   iterator       find        (ValueT const & value) noexcept {return iterator (const_cast<Hook *> (Find (value)));}
+
+   const_iterator lower_bound (ValueT const & value) const noexcept {return const_iterator (LowerBound (value));}
+
+   iterator       lower_bound (ValueT const & value) noexcept {return iterator (const_cast<Hook *> (LowerBound (value)));}
+
+   const_iterator upper_bound (ValueT const & value) const noexcept {return const_iterator (UpperBound (value));}
+
+   iterator       upper_bound (ValueT const & value) noexcept {return iterator (const_cast<Hook *> (UpperBound (value)));}
+
+   // Heterogeneous lookups, as in BinarySearchTree.
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator find        (KeyT const & key) const noexcept {return const_iterator (Find (key));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   iterator       find        (KeyT const & key) noexcept {return iterator (const_cast<Hook *> (Find (key)));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator lower_bound (KeyT const & key) const noexcept {return const_iterator (LowerBound (key));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   iterator       lower_bound (KeyT const & key) noexcept {return iterator (const_cast<Hook *> (LowerBound (key)));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator upper_bound (KeyT const & key) const noexcept {return const_iterator (UpperBound (key));}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   iterator       upper_bound (KeyT const & key) noexcept {return iterator (const_cast<Hook *> (UpperBound (key)));}
+
+   bool           empty () const noexcept {return i_header.size == 0;}
+
+   size_type      size  () const noexcept {return i_header.size;}
+
+   #pragma endregion
+
+   #pragma region Modifiers
+
+   using insertion_t = std::pair<iterator, bool>;
+
+   // Links value, which must not be linked yet; returns the equivalent element instead if there is one.
+   insertion_t insert   (ValueT & value) noexcept;
+
+   // Unlinks the element at position, returns the following one.
+   iterator    erase    (const_iterator position) noexcept;
+
+   // Unlinks value, which must belong to this tree.
+   void        erase    (ValueT & value) noexcept {HookOf (&value)->unlink ();}
+
+   void        clear    () noexcept;
+
+   #pragma endregion
+
+private:
+
+   #pragma region iterator base
+
+   template <typename T>
+   class iterator_base
+   {
+      using self_t = iterator_base <T>;
+
+      using hook_t = std::conditional_t <std::is_const_v <T>, Hook const, Hook>;
+
+   public:
+
+      using iterator_category = std::bidirectional_iterator_tag;
+
+      using value_type        = std::remove_const_t <T>;
+
+      using difference_type   = std::ptrdiff_t;
+
+      using pointer           = T *;
+
+      using reference         = T &;
+
+      iterator_base () : i_current (nullptr) {}
+
+      explicit iterator_base (hook_t * current) : i_current (current) {}
+
+      template <typename U, typename = std::enable_if_t <std::is_same_v <U const, T> && !std::is_same_v <U, T>>>
+      iterator_base (iterator_base <U> const & it) : i_current (it.i_current) {}
+
+      reference   operator *  () const {return *static_cast<pointer> (i_current);}
+
+      pointer     operator -> () const {return static_cast<pointer> (i_current);}
+
+      self_t & operator ++ ()    {i_current = i_current->i_next; return *this;}
+
+      self_t   operator ++ (int) {auto result = *this; ++(*this); return result;}
+
+      self_t & operator -- ()    {i_current = i_current->i_prev; return *this;}
+
+      self_t   operator -- (int) {auto result = *this; --(*this); return result;}
+
+      bool     operator == (self_t it) const {return i_current == it.i_current;}
+
+      bool     operator != (self_t it) const {return !(*this == it);}
+
+   private:
+
+      friend IntrusiveSearchTree <ValueT, CompareT, TagT>;
+
+      template <typename> friend class iterator_base;
+
+      hook_t * i_current;
+   };
+
+   #pragma endregion
+
+   static Hook *        HookOf  (ValueT * value) noexcept {return value;}
+
+   static Hook const *  HookOf  (ValueT const * value) noexcept {return value;}
+
+   static ValueT const & ValueOf (Hook const * hook) noexcept {return *static_cast<ValueT const *> (hook);}
+
+   // Lookups return the end sentinel when nothing qualifies.
+   template <typename KeyT>
+   Hook const *   LowerBound  (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   Hook const *   UpperBound  (KeyT const & key) const noexcept;
+
+   template <typename KeyT>
+   Hook const *   Find        (KeyT const & key) const noexcept;
+
+   static const CompareT f_compare;
+
+   Header i_header;
+};
+
+template < typename ValueT, typename CompareT, typename TagT >
+const CompareT IntrusiveSearchTree <ValueT, CompareT, TagT>::f_compare {};
+
+template < typename ValueT, typename CompareT, typename TagT >
+IntrusiveSearchTree <ValueT, CompareT, TagT>::~IntrusiveSearchTree ()
+{
+   clear ();
+}
+
+template < typename ValueT, typename CompareT, typename TagT >
+template < typename KeyT >
+typename IntrusiveSearchTree <ValueT, CompareT, TagT>::Hook const * IntrusiveSearchTree <ValueT, CompareT, TagT>::LowerBound (KeyT const & key) const noexcept
+{
+   Hook const * candidate = &i_header.end;
+
+   for (Hook const * current = i_header.root; current;)
+   {
+      bool const less = f_compare (ValueOf (current), key);
+
+      candidate = less ? candidate : current;
+      current   = less ? current->i_right : current->i_left;
+   }
+
+   return candidate;
+}
+
+template < typename ValueT, typename CompareT, typename TagT >
+template < typename KeyT >
+typename IntrusiveSearchTree <ValueT, CompareT, TagT>::Hook const * IntrusiveSearchTree <ValueT, CompareT, TagT>::UpperBound (KeyT const & key) const noexcept
+{
+   Hook const * candidate = &i_header.end;
+
+   for (Hook const * current = i_header.root; current;)
+   {
+      bool const greater = f_compare (key, ValueOf (current));
+
+      candidate = greater ? current : candidate;
+      current   = greater ? current->i_left : current->i_right;
+   }
+
+   return candidate;
+}
+
+template < typename ValueT, typename CompareT, typename TagT >
+template < typename KeyT >
+typename IntrusiveSearchTree <ValueT, CompareT, TagT>::Hook const * IntrusiveSearchTree <ValueT, CompareT, TagT>::Find (KeyT const & key) const noexcept
+{
+   auto const candidate = LowerBound (key);
+
+   return candidate != &i_header.end && !f_compare (key, ValueOf (candidate)) ? candidate : &i_header.end;
+}
+
+template < typename ValueT, typename CompareT, typename TagT >
+typename IntrusiveSearchTree <ValueT, CompareT, TagT>::insertion_t IntrusiveSearchTree <ValueT, CompareT, TagT>::insert (ValueT & value) noexcept
+{
+   auto const hook = HookOf (&value);
+
+   Hook * parent = nullptr;
+   Hook * candidate = nullptr;
+   bool   less = false;
+
+   for (auto current = i_header.root; current;)
+   {
+      parent = current;
+      less = f_compare (ValueOf (current), value);
+
+      candidate = less ? candidate : current;
+      current   = less ? current->i_right : current->i_left;
+   }
+
+   if (candidate && !f_compare (value, ValueOf (candidate))) return insertion_t (iterator (candidate), false);
+
+   hook->i_parent = parent;
+   hook->i_header = &i_header;
+
+   // The new leaf's in-order neighbours are its parent and the parent's neighbour on the same side.
+   if (!parent)
+   {
+      i_header.root = hook;
+      hook->i_prev = hook->i_next = &i_header.end;
+   }
+   else if (less)
+   {
+      parent->i_right = hook;
+      hook->i_prev = parent;
+      hook->i_next = parent->i_next;
+   }
+   else
+   {
+      parent->i_left = hook;
+      hook->i_prev = parent->i_prev;
+      hook->i_next = parent;
+   }
+
+   hook->i_prev->i_next = hook;
+   hook->i_next->i_prev = hook;
+
+   ++i_header.size;
+
+   return insertion_t (iterator (hook), true);
+}
+
+template < typename ValueT, typename CompareT, typename TagT >
+typename IntrusiveSearchTree <ValueT, CompareT, TagT>::iterator IntrusiveSearchTree <ValueT, CompareT, TagT>::erase (const_iterator position) noexcept
+{
+   auto const current = const_cast<Hook *> (position.i_current);
+   auto const next = current->i_next;
+
+   current->unlink ();
+
+   return iterator (next);
+}
+
+template < typename ValueT, typename CompareT, typename TagT >
+void IntrusiveSearchTree <ValueT, CompareT, TagT>::clear () noexcept
+{
+   // No structure to maintain on the way out: reset every hook along the thread list.
+   for (auto current = i_header.end.i_next; current != &i_header.end;)
+   {
+      auto const next = current->i_next;
+
+      current->i_parent = current->i_left = current->i_right = current->i_prev = current->i_next = nullptr;
+      current->i_header = nullptr;
+
+      current = next;
+   }
+
+   i_header.end.i_prev = i_header.end.i_next = &i_header.end;
+   i_header.root = nullptr;
+   i_header.size = 0;
+}
+
+}
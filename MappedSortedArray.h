@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BinarySearchTree.h"
+#include "Sorting.h"
+
+namespace utilities
+{
+
+// On-disk image of a sorted set of trivially copyable payloads: a fixed 64 byte header followed
+// by the payloads in order, with no pointers. It is written by SaveSortedArray and mapped back by
+// MappedSortedArray, which serves lookups and iteration straight from the page cache; a mutable
+// tree is one O(n) bulk build away:
+//
+//    BinarySearchTree<T> tree (sorted_unique, image.begin (), image.end ());
+//
+// The image is only meant to be read on the architecture that wrote it (checked on load).
+
+struct SortedArrayHeader
+{
+   static constexpr char         f_magic [8]    = {'B', 'S', 'T', 'S', 'O', 'R', 'T', '1'};
+   static constexpr std::uint32_t f_byteOrder   = 0x01020304;
+
+   char           magic [8];
+   std::uint32_t  byteOrder;
+   std::uint32_t  payloadSize;
+   std::uint32_t  payloadAlignment;
+   std::uint32_t  reserved;
+   std::uint64_t  count;
+   char           padding [32];
+};
+
+static_assert (sizeof (SortedArrayHeader) == 64, "payloads must start on a 64 byte boundary");
+
+// Writes [first, last), which must be sorted and free of duplicates and hold count elements, to path.
+// The image is written to path + ".tmp" and renamed over path once complete, so a failed save leaves
+// any previous image in place. Throws std::invalid_argument if the range does not hold count elements.
+template <typename IteratorT>
+void SaveSortedArray (std::string const & path, IteratorT first, IteratorT last, std::size_t count)
+{
+   using PayloadT = typename std::iterator_traits<IteratorT>::value_type;
+
+   static_assert (std::is_trivially_copyable_v<PayloadT>, "only trivially copyable payloads can be saved");
+   static_assert (alignof (PayloadT) <= sizeof (SortedArrayHeader), "payload alignment exceeds the header size");
+
+   auto const temporary = path + ".tmp";
+
+   std::ofstream output (temporary, std::ios::binary | std::ios::trunc);
+
+   if (!output) throw std::runtime_error ("SaveSortedArray: cannot open " + temporary);
+
+   auto fail = [&output, &temporary] (auto const & error)
+   {
+      output.close ();
+      std::remove (temporary.c_str ());
+      throw error;
+   };
+
+   SortedArrayHeader header {};
+
+   std::memcpy (header.magic, SortedArrayHeader::f_magic, sizeof (header.magic));
+   header.byteOrder        = SortedArrayHeader::f_byteOrder;
+   header.payloadSize      = sizeof (PayloadT);
+   header.payloadAlignment = alignof (PayloadT);
+   header.count            = static_cast<std::uint64_t> (count);
+
+   output.write (reinterpret_cast<char const *> (&header), sizeof (header));
+
+   std::size_t written = 0;
+
+   for (; first != last && written < count; ++first, ++written)
+   {
+      PayloadT const & value = *first;
+      output.write (reinterpret_cast<char const *> (&value), sizeof (PayloadT));
+   }
+
+   if (written != count || first != last) fail (std::invalid_argument ("SaveSortedArray: the range does not hold count elements"));
+
+   if (!output.flush ()) fail (std::runtime_error ("SaveSortedArray: cannot write " + temporary));
+
+   output.close ();
+
+   if (std::rename (temporary.c_str (), path.c_str ()) != 0)
+   {
+      auto error = errno;
+      std::remove (temporary.c_str ());
+      throw std::system_error (error, std::generic_category (), "SaveSortedArray: cannot replace " + path);
+   }
+}
+
+template <typename IteratorT>
+void SaveSortedArray (std::string const & path, IteratorT first, IteratorT last)
+{
+   auto const count = static_cast<std::size_t> (std::distance (first, last));
+
+   SaveSortedArray (path, first, last, count);
+}
+
+template <typename PayloadT, typename CompareT, typename... OptionsT>
+void SaveSortedArray (std::string const & path, BinarySearchTree<PayloadT, CompareT, OptionsT...> const & tree)
+{
+   SaveSortedArray (path, tree.begin (), tree.end (), tree.size ());
+}
+
+// Read-only view of a file written by SaveSortedArray, mapped into memory.
+template < typename PayloadT, typename CompareT = std::less <PayloadT> >
+class MappedSortedArray
+{
+   static_assert (std::is_trivially_copyable_v<PayloadT>, "only trivially copyable payloads can be mapped");
+
+public:
+
+   using size_type         = std::size_t;
+
+   using const_iterator    = PayloadT const *;
+
+   using iterator          = const_iterator;
+
+   #pragma region Construction, Dectruction, Assignment
+
+   explicit MappedSortedArray (std::string const & path);
+
+   MappedSortedArray (MappedSortedArray const &) = delete;
+
+   MappedSortedArray (MappedSortedArray && other) noexcept;
+
+   MappedSortedArray & operator = (MappedSortedArray const &) = delete;
+
+   MappedSortedArray & operator = (MappedSortedArray && other) noexcept;
+
+   ~MappedSortedArray ();
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   const_iterator begin    () const noexcept {return i_data;}
+   const_iterator cbegin   () const noexcept {return i_data;}
+   const_iterator end      () const noexcept {return i_data + i_size;}
+   const_iterator cend     () const noexcept {return i_data + i_size;}
+
+   size_type      size     () const noexcept {return i_size;}
+
+   bool           empty    () const noexcept {return i_size == 0;}
+
+   PayloadT const & operator [] (size_type index) const noexcept {return i_data [index];}
+
+   const_iterator find        (PayloadT const & value) const noexcept;
+
+   const_iterator lower_bound (PayloadT const & value) const noexcept;
+
+   const_iterator upper_bound (PayloadT const & value) const noexcept;
+
+   #pragma endregion
+
+private:
+
+   void Unmap () noexcept;
+
+   static const CompareT f_compare;
+
+   void *            i_mapping;
+   std::size_t       i_mappingSize;
+   PayloadT const *  i_data;
+   size_type         i_size;
+};
+
+template < typename PayloadT, typename CompareT >
+const CompareT MappedSortedArray <PayloadT, CompareT>::f_compare {};
+
+template < typename PayloadT, typename CompareT >
+MappedSortedArray <PayloadT, CompareT>::MappedSortedArray (std::string const & path)
+: i_mapping (nullptr), i_mappingSize (0), i_data (nullptr), i_size (0)
+{
+   auto fd = ::open (path.c_str (), O_RDONLY);
+
+   if (fd < 0) throw std::system_error (errno, std::generic_category (), "MappedSortedArray: cannot open " + path);
+
+   struct stat status;
+
+   if (::fstat (fd, &status) != 0)
+   {
+      auto error = errno;
+      ::close (fd);
+      throw std::system_error (error, std::generic_category (), "MappedSortedArray: cannot stat " + path);
+   }
+
+   i_mappingSize = static_cast<std::size_t> (status.st_size);
+
+   if (i_mappingSize < sizeof (SortedArrayHeader))
+   {
+      ::close (fd);
+      throw std::runtime_error ("MappedSortedArray: truncated header in " + path);
+   }
+
+   i_mapping = ::mmap (nullptr, i_mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+   auto error = errno;
+   ::close (fd);
+
+   if (i_mapping == MAP_FAILED)
+   {
+      i_mapping = nullptr;
+      throw std::system_error (error, std::generic_category (), "MappedSortedArray: cannot map " + path);
+   }
+
+   auto header = static_cast<SortedArrayHeader const *> (i_mapping);
+
+   bool const valid = std::memcmp (header->magic, SortedArrayHeader::f_magic, sizeof (header->magic)) == 0
+                   && header->byteOrder == SortedArrayHeader::f_byteOrder
+                   && header->payloadSize == sizeof (PayloadT)
+                   && header->payloadAlignment == alignof (PayloadT)
+                   && header->count <= (i_mappingSize - sizeof (SortedArrayHeader)) / sizeof (PayloadT);
+
+   if (!valid)
+   {
+      Unmap ();
+      throw std::runtime_error ("MappedSortedArray: " + path + " is not a sorted array of this payload type");
+   }
+
+   i_data = reinterpret_cast<PayloadT const *> (static_cast<char const *> (i_mapping) + sizeof (SortedArrayHeader));
+   i_size = static_cast<size_type> (header->count);
+}
+
+template < typename PayloadT, typename CompareT >
+MappedSortedArray <PayloadT, CompareT>::MappedSortedArray (MappedSortedArray && other) noexcept
+: i_mapping (other.i_mapping), i_mappingSize (other.i_mappingSize), i_data (other.i_data), i_size (other.i_size)
+{
+   other.i_mapping = nullptr;
+   other.i_data = nullptr;
+   other.i_size = 0;
+}
+
+template < typename PayloadT, typename CompareT >
+MappedSortedArray <PayloadT, CompareT> & MappedSortedArray <PayloadT, CompareT>::operator = (MappedSortedArray && other) noexcept
+{
+   if (this == &other) return *this;
+
+   Unmap ();
+
+   std::swap (i_mapping, other.i_mapping);
+   std::swap (i_mappingSize, other.i_mappingSize);
+   std::swap (i_data, other.i_data);
+   std::swap (i_size, other.i_size);
+
+   return *this;
+}
+
+template < typename PayloadT, typename CompareT >
+MappedSortedArray <PayloadT, CompareT>::~MappedSortedArray ()
+{
+   Unmap ();
+}
+
+template < typename PayloadT, typename CompareT >
+void MappedSortedArray <PayloadT, CompareT>::Unmap () noexcept
+{
+   if (i_mapping) ::munmap (i_mapping, i_mappingSize);
+
+   i_mapping = nullptr;
+   i_data = nullptr;
+   i_size = 0;
+}
+
+template < typename PayloadT, typename CompareT >
+typename MappedSortedArray <PayloadT, CompareT>::const_iterator MappedSortedArray <PayloadT, CompareT>::lower_bound (PayloadT const & value) const noexcept
+{
+   return BranchlessLowerBound (i_data, i_data + i_size, value, f_compare);
+}
+
+template < typename PayloadT, typename CompareT >
+typename MappedSortedArray <PayloadT, CompareT>::const_iterator MappedSortedArray <PayloadT, CompareT>::upper_bound (PayloadT const & value) const noexcept
+{
+   return BranchlessUpperBound (i_data, i_data + i_size, value, f_compare);
+}
+
+template < typename PayloadT, typename CompareT >
+typename MappedSortedArray <PayloadT, CompareT>::const_iterator MappedSortedArray <PayloadT, CompareT>::find (PayloadT const & value) const noexcept
+{
+   auto result = lower_bound (value);
+
+   return result != end () && !f_compare (value, *result) ? result : end ();
+}
+
+}
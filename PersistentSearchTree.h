@@ -0,0 +1,551 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace utilities
+{
+
+// Persistent (immutable-node) ordered set: a randomized treap updated by path copying.
+// Subtrees are shared between versions through reference counting, so
+//    - a snapshot is an O(1) copy of the root,
+//    - an update copies the O(log n) expected nodes on its path and leaves every snapshot untouched,
+//    - nodes are reclaimed when the last version referencing them goes away.
+// A single writer may update a tree while other threads call snapshot () on it; every snapshot is
+// then a private, stable view that can be read without synchronisation.
+// Every tree, copy and snapshot draws its priorities from its own freshly seeded engine, so versions
+// that diverge from a common ancestor do not repeat each other's priorities.
+template < typename PayloadT, typename CompareT = std::less <PayloadT> >
+class PersistentSearchTree
+{
+   using Self_t = PersistentSearchTree<PayloadT, CompareT>;
+
+   class Node;
+
+   using NodePtr = std::shared_ptr<Node const>;
+
+public:
+
+   using size_type = std::size_t;
+
+   #pragma region Construction, Dectruction, Assignment
+
+   PersistentSearchTree ();
+
+   PersistentSearchTree (PersistentSearchTree const & tree);
+
+   PersistentSearchTree (PersistentSearchTree &&) = default;
+
+   PersistentSearchTree (std::initializer_list<PayloadT> && Values);
+
+   template <typename IteratorT>
+   PersistentSearchTree (IteratorT first, IteratorT last);
+
+   // Shares the nodes of tree, keeps this tree's priority engine.
+   PersistentSearchTree & operator = (PersistentSearchTree const & tree);
+
+   PersistentSearchTree & operator = (PersistentSearchTree &&) = default;
+
+   ~PersistentSearchTree () = default;
+
+   // O(1): shares every node with this tree. Safe to call while another thread updates this tree.
+   PersistentSearchTree snapshot () const;
+
+   #pragma endregion
+
+   #pragma region Iterator
+
+   class const_iterator;
+
+   using iterator = const_iterator;
+
+   const_iterator begin    () const;
+   const_iterator cbegin   () const;
+   const_iterator end      () const;
+   const_iterator cend     () const;
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   const_iterator find        (PayloadT const & value) const;
+
+   const_iterator lower_bound (PayloadT const & value) const;
+
+   const_iterator upper_bound (PayloadT const & value) const;
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator find        (KeyT const & key) const {return Find (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator lower_bound (KeyT const & key) const {return LowerBound (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   const_iterator upper_bound (KeyT const & key) const {return UpperBound (key);}
+
+   bool           empty () const noexcept;
+
+   size_type      size  () const noexcept;
+
+   #pragma endregion
+
+   #pragma region Modifiers
+
+   // Returns false if an equivalent element is already present.
+   template <typename... ArgsT>
+   bool        emplace  (ArgsT&&... args);
+
+   bool        insert   (PayloadT const & value) {return emplace (value);}
+
+   bool        insert   (PayloadT && value) {return emplace (std::move (value));}
+
+   // Returns the number of removed elements (0 or 1).
+   size_type   erase    (PayloadT const & value);
+
+   void        clear    ();
+
+   #pragma endregion
+
+private:
+
+   #pragma region Node declaration / definition
+
+   class Node
+   {
+   public:
+
+      Node () = delete;
+
+      template <typename... ArgsT>
+      Node (NodePtr left, NodePtr right, std::uint32_t priority, ArgsT&&... args)
+      : i_left (std::move (left)), i_right (std::move (right)), i_size (1 + SizeOf (i_left) + SizeOf (i_right)), i_priority (priority), i_value (std::forward<ArgsT> (args)...)
+      {
+      }
+
+      PayloadT const &  value    () const {return i_value;}
+
+      NodePtr const &   left     () const {return i_left;}
+
+      NodePtr const &   right    () const {return i_right;}
+
+      size_type         size     () const {return i_size;}
+
+      std::uint32_t     priority () const {return i_priority;}
+
+   private:
+
+      NodePtr        i_left;
+      NodePtr        i_right;
+      size_type      i_size;
+      std::uint32_t  i_priority;
+
+      PayloadT       i_value;
+   };
+
+   #pragma endregion
+
+public:
+
+   #pragma region const_iterator
+
+   // Forward iterator over one version. It keeps the path of pending ancestors, so it stays valid
+   // as long as the version it was obtained from (or any snapshot of it) is alive.
+   class const_iterator
+   {
+   public:
+
+      using iterator_category = std::forward_iterator_tag;
+
+      using value_type        = PayloadT;
+
+      using difference_type   = std::ptrdiff_t;
+
+      using reference         = PayloadT const &;
+
+      using pointer           = PayloadT const *;
+
+      const_iterator () = default;
+
+      reference         operator *  () const {return i_path.back ()->value ();}
+
+      pointer           operator -> () const {return &(i_path.back ()->value ());}
+
+      const_iterator &  operator ++ ()
+      {
+         auto current = i_path.back ();
+         i_path.pop_back ();
+         pushLeftPath (current->right ().get ());
+         return *this;
+      }
+
+      const_iterator    operator ++ (int) {auto result = *this; ++(*this); return result;}
+
+      bool              operator == (const_iterator const & it) const
+      {
+         return i_path.empty () ? it.i_path.empty () : !it.i_path.empty () && i_path.back () == it.i_path.back ();
+      }
+
+      bool              operator != (const_iterator const & it) const {return !(*this == it);}
+
+   private:
+
+      friend PersistentSearchTree <PayloadT, CompareT>;
+
+      void pushLeftPath (Node const * current)
+      {
+         for (; current; current = current->left ().get ()) i_path.push_back (current);
+      }
+
+      // Current node on top, below it every ancestor whose left subtree contains the current node.
+      std::vector<Node const *> i_path;
+   };
+
+   #pragma endregion
+
+private:
+
+   explicit PersistentSearchTree (NodePtr root);
+
+   static size_type  SizeOf   (NodePtr const & node) noexcept {return node ? node->size () : 0;}
+
+   template <typename... ArgsT>
+   static NodePtr    MakeNode (NodePtr left, NodePtr right, std::uint32_t priority, ArgsT&&... args);
+
+   // Copy of node with new children (the path-copying step).
+   static NodePtr    Rebuild  (Node const & node, NodePtr left, NodePtr right);
+
+   static NodePtr    Insert   (NodePtr const & root, NodePtr const & leaf, bool & inserted);
+
+   template <typename KeyT>
+   static NodePtr    Erase    (NodePtr const & root, KeyT const & key, bool & erased);
+
+   static NodePtr    Merge    (NodePtr const & left, NodePtr const & right);
+
+   bool              Contains (PayloadT const & value) const;
+
+   // Seeds each tree's priority engine, from std::random_device once per thread.
+   static std::uint32_t NewSeed ();
+
+   template <typename KeyT>
+   const_iterator    LowerBound  (KeyT const & key) const;
+
+   template <typename KeyT>
+   const_iterator    UpperBound  (KeyT const & key) const;
+
+   template <typename KeyT>
+   const_iterator    Find        (KeyT const & key) const;
+
+   NodePtr           Root        () const {return std::atomic_load (&i_root);}
+
+   void              Publish     (NodePtr root) {std::atomic_store (&i_root, std::move (root));}
+
+   static const CompareT f_compare;
+
+   NodePtr           i_root;
+   std::minstd_rand  i_random;
+};
+
+template < typename PayloadT, typename CompareT >
+const CompareT PersistentSearchTree <PayloadT, CompareT>::f_compare {};
+
+template < typename PayloadT, typename CompareT >
+PersistentSearchTree <PayloadT, CompareT>::PersistentSearchTree ()
+: i_root (nullptr), i_random (NewSeed ())
+{
+}
+
+template < typename PayloadT, typename CompareT >
+PersistentSearchTree <PayloadT, CompareT>::PersistentSearchTree (PersistentSearchTree const & tree)
+: i_root (tree.Root ()), i_random (NewSeed ())
+{
+}
+
+template < typename PayloadT, typename CompareT >
+PersistentSearchTree <PayloadT, CompareT>::PersistentSearchTree (NodePtr root)
+: i_root (std::move (root)), i_random (NewSeed ())
+{
+}
+
+template < typename PayloadT, typename CompareT >
+PersistentSearchTree <PayloadT, CompareT> & PersistentSearchTree <PayloadT, CompareT>::operator = (PersistentSearchTree const & tree)
+{
+   Publish (tree.Root ());
+
+   return *this;
+}
+
+template < typename PayloadT, typename CompareT >
+std::uint32_t PersistentSearchTree <PayloadT, CompareT>::NewSeed ()
+{
+   thread_local std::mt19937 seeds (std::random_device {} ());
+
+   return static_cast<std::uint32_t> (seeds ());
+}
+
+template < typename PayloadT, typename CompareT >
+PersistentSearchTree <PayloadT, CompareT>::PersistentSearchTree (std::initializer_list<PayloadT> && Values)
+: PersistentSearchTree (Values.begin (), Values.end ())
+{
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename IteratorT >
+PersistentSearchTree <PayloadT, CompareT>::PersistentSearchTree (IteratorT first, IteratorT last)
+: PersistentSearchTree ()
+{
+   for (; first != last; ++first) emplace (*first);
+}
+
+template < typename PayloadT, typename CompareT >
+PersistentSearchTree <PayloadT, CompareT> PersistentSearchTree <PayloadT, CompareT>::snapshot () const
+{
+   return PersistentSearchTree (Root ());
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename... ArgsT >
+typename PersistentSearchTree <PayloadT, CompareT>::NodePtr PersistentSearchTree <PayloadT, CompareT>::MakeNode (NodePtr left, NodePtr right, std::uint32_t priority, ArgsT&&... args)
+{
+   return std::make_shared<Node const> (std::move (left), std::move (right), priority, std::forward<ArgsT> (args)...);
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::NodePtr PersistentSearchTree <PayloadT, CompareT>::Rebuild (Node const & node, NodePtr left, NodePtr right)
+{
+   return MakeNode (std::move (left), std::move (right), node.priority (), node.value ());
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::NodePtr PersistentSearchTree <PayloadT, CompareT>::Insert (NodePtr const & root, NodePtr const & leaf, bool & inserted)
+{
+   if (!root) return leaf;
+
+   if (f_compare (leaf->value (), root->value ()))
+   {
+      auto left = Insert (root->left (), leaf, inserted);
+
+      if (!inserted) return root;
+
+      if (left->priority () <= root->priority ()) return Rebuild (*root, std::move (left), root->right ());
+
+      // Rotate right: the new left child moves up.
+      return Rebuild (*left, left->left (), Rebuild (*root, left->right (), root->right ()));
+   }
+
+   if (f_compare (root->value (), leaf->value ()))
+   {
+      auto right = Insert (root->right (), leaf, inserted);
+
+      if (!inserted) return root;
+
+      if (right->priority () <= root->priority ()) return Rebuild (*root, root->left (), std::move (right));
+
+      // Rotate left: the new right child moves up.
+      return Rebuild (*right, Rebuild (*root, root->left (), right->left ()), right->right ());
+   }
+
+   inserted = false;
+
+   return root;
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::NodePtr PersistentSearchTree <PayloadT, CompareT>::Merge (NodePtr const & left, NodePtr const & right)
+{
+   if (!left) return right;
+   if (!right) return left;
+
+   if (left->priority () > right->priority ()) return Rebuild (*left, left->left (), Merge (left->right (), right));
+
+   return Rebuild (*right, Merge (left, right->left ()), right->right ());
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename KeyT >
+typename PersistentSearchTree <PayloadT, CompareT>::NodePtr PersistentSearchTree <PayloadT, CompareT>::Erase (NodePtr const & root, KeyT const & key, bool & erased)
+{
+   if (!root) return root;
+
+   if (f_compare (key, root->value ()))
+   {
+      auto left = Erase (root->left (), key, erased);
+
+      return erased ? Rebuild (*root, std::move (left), root->right ()) : root;
+   }
+
+   if (f_compare (root->value (), key))
+   {
+      auto right = Erase (root->right (), key, erased);
+
+      return erased ? Rebuild (*root, root->left (), std::move (right)) : root;
+   }
+
+   erased = true;
+
+   return Merge (root->left (), root->right ());
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename... ArgsT >
+bool PersistentSearchTree <PayloadT, CompareT>::emplace (ArgsT&&... args)
+{
+   PayloadT value (std::forward<ArgsT> (args)...);
+
+   // Nothing is allocated for a value that is already present.
+   if (Contains (value)) return false;
+
+   auto leaf = MakeNode (nullptr, nullptr, static_cast<std::uint32_t> (i_random ()), std::move (value));
+
+   bool inserted = true;
+
+   auto root = Insert (i_root, leaf, inserted);
+
+   if (inserted) Publish (std::move (root));
+
+   return inserted;
+}
+
+template < typename PayloadT, typename CompareT >
+bool PersistentSearchTree <PayloadT, CompareT>::Contains (PayloadT const & value) const
+{
+   for (auto current = i_root.get (); current;)
+   {
+      if (f_compare (value, current->value ())) current = current->left ().get ();
+      else if (f_compare (current->value (), value)) current = current->right ().get ();
+      else return true;
+   }
+
+   return false;
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::size_type PersistentSearchTree <PayloadT, CompareT>::erase (PayloadT const & value)
+{
+   bool erased = false;
+
+   auto root = Erase (i_root, value, erased);
+
+   if (erased) Publish (std::move (root));
+
+   return erased ? 1 : 0;
+}
+
+template < typename PayloadT, typename CompareT >
+void PersistentSearchTree <PayloadT, CompareT>::clear ()
+{
+   Publish (nullptr);
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename KeyT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::LowerBound (KeyT const & key) const
+{
+   const_iterator result;
+
+   for (auto current = i_root.get (); current;)
+   {
+      bool const less = f_compare (current->value (), key);
+
+      if (!less) result.i_path.push_back (current);
+
+      current = less ? current->right ().get () : current->left ().get ();
+   }
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename KeyT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::UpperBound (KeyT const & key) const
+{
+   const_iterator result;
+
+   for (auto current = i_root.get (); current;)
+   {
+      bool const greater = f_compare (key, current->value ());
+
+      if (greater) result.i_path.push_back (current);
+
+      current = greater ? current->left ().get () : current->right ().get ();
+   }
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename KeyT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::Find (KeyT const & key) const
+{
+   auto result = LowerBound (key);
+
+   if (result != cend () && f_compare (key, *result)) return cend ();
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::find (PayloadT const & value) const
+{
+   return Find (value);
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::lower_bound (PayloadT const & value) const
+{
+   return LowerBound (value);
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::upper_bound (PayloadT const & value) const
+{
+   return UpperBound (value);
+}
+
+template < typename PayloadT, typename CompareT >
+bool PersistentSearchTree <PayloadT, CompareT>::empty () const noexcept
+{
+   return !i_root;
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::size_type PersistentSearchTree <PayloadT, CompareT>::size () const noexcept
+{
+   return SizeOf (i_root);
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::begin () const
+{
+   return cbegin ();
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::cbegin () const
+{
+   const_iterator result;
+
+   result.pushLeftPath (i_root.get ());
+
+   return result;
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::end () const
+{
+   return cend ();
+}
+
+template < typename PayloadT, typename CompareT >
+typename PersistentSearchTree <PayloadT, CompareT>::const_iterator PersistentSearchTree <PayloadT, CompareT>::cend () const
+{
+   return const_iterator ();
+}
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include "Sorting.h"
+#include "TemplateMetaProgramming.h"
+
+namespace utilities
+{
+
+// Immutable sorted array of literal values. The constructor sorts and validates its input, so a
+// constexpr table is laid out by the compiler and costs nothing at startup:
+//
+//    constexpr SortedTable keywords (std::array<std::string_view, 3> {"while", "if", "else"});
+//    static_assert (keywords.contains ("if"));
+//
+// Lookups are the branchless halving search of Sorting.h, usable in constant expressions.
+template < typename ValueT, std::size_t SizeV, typename CompareT = std::less <ValueT> >
+class SortedTable
+{
+public:
+
+   using value_type        = ValueT;
+
+   using size_type         = std::size_t;
+
+   using const_iterator    = ValueT const *;
+
+   using iterator          = const_iterator;
+
+   #pragma region Construction
+
+   // Throws std::invalid_argument when two values are equivalent, which turns into a compilation
+   // error when the table is constexpr.
+   constexpr explicit SortedTable (std::array<ValueT, SizeV> const & values);
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   constexpr const_iterator begin    () const noexcept {return i_values.data ();}
+   constexpr const_iterator cbegin   () const noexcept {return begin ();}
+   constexpr const_iterator end      () const noexcept {return i_values.data () + SizeV;}
+   constexpr const_iterator cend     () const noexcept {return end ();}
+
+   constexpr size_type      size     () const noexcept {return SizeV;}
+
+   constexpr bool           empty    () const noexcept {return SizeV == 0;}
+
+   constexpr ValueT const & operator [] (size_type index) const noexcept {return i_values [index];}
+
+   constexpr std::array<ValueT, SizeV> const & values () const noexcept {return i_values;}
+
+   constexpr const_iterator find        (ValueT const & value) const noexcept {return Find (value);}
+
+   constexpr const_iterator lower_bound (ValueT const & value) const noexcept {return LowerBound (value);}
+
+   constexpr const_iterator upper_bound (ValueT const & value) const noexcept {return UpperBound (value);}
+
+   constexpr bool           contains    (ValueT const & value) const noexcept {return Find (value) != end ();}
+
+   // Heterogeneous lookups, as in BinarySearchTree.
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   constexpr const_iterator find        (KeyT const & key) const noexcept {return Find (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   constexpr const_iterator lower_bound (KeyT const & key) const noexcept {return LowerBound (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   constexpr const_iterator upper_bound (KeyT const & key) const noexcept {return UpperBound (key);}
+
+   template <typename KeyT, typename C = CompareT, typename = typename C::is_transparent>
+   constexpr bool           contains    (KeyT const & key) const noexcept {return Find (key) != end ();}
+
+   #pragma endregion
+
+private:
+
+   template <typename KeyT>
+   constexpr const_iterator LowerBound (KeyT const & key) const noexcept {return BranchlessLowerBound (begin (), end (), key, f_compare);}
+
+   template <typename KeyT>
+   constexpr const_iterator UpperBound (KeyT const & key) const noexcept {return BranchlessUpperBound (begin (), end (), key, f_compare);}
+
+   template <typename KeyT>
+   constexpr const_iterator Find       (KeyT const & key) const noexcept;
+
+   static constexpr CompareT f_compare {};
+
+   std::array<ValueT, SizeV> i_values;
+};
+
+template <typename ValueT, std::size_t SizeV>
+SortedTable (std::array<ValueT, SizeV> const &) -> SortedTable<ValueT, SizeV>;
+
+template < typename ValueT, std::size_t SizeV, typename CompareT >
+constexpr SortedTable <ValueT, SizeV, CompareT>::SortedTable (std::array<ValueT, SizeV> const & values)
+: i_values (values)
+{
+   // Merge sort into a scratch array: no allocation, and only log2 (SizeV) deep, which keeps large
+   // tables within the compilers' constexpr recursion limits.
+   std::array<ValueT, SizeV> buffer {};
+
+   MergeSort (i_values.begin (), i_values.end (), buffer.begin (), f_compare);
+
+   for (size_type index = 1; index < SizeV; ++index)
+   {
+      if (!f_compare (i_values [index - 1], i_values [index])) throw std::invalid_argument ("SortedTable: equivalent values");
+   }
+}
+
+template < typename ValueT, std::size_t SizeV, typename CompareT >
+template < typename KeyT >
+constexpr typename SortedTable <ValueT, SizeV, CompareT>::const_iterator SortedTable <ValueT, SizeV, CompareT>::Find (KeyT const & key) const noexcept
+{
+   auto const result = LowerBound (key);
+
+   return result != end () && !f_compare (key, *result) ? result : end ();
+}
+
+namespace detail
+{
+
+// Converter handing each type to TypeToValueConverter as is, so that T::value is taken directly.
+template <typename T>
+using Identity = T;
+
+}
+
+// Table of the static value members of a TypeSequence of types, e.g. std::integral_constant or
+// descriptor types declared next to the code they name:
+//
+//    constexpr auto opcodes = MakeSortedTable <tmp::TypeSequence<Add, Sub, Jump>> ();
+template < typename SequenceT, typename CompareT = void >
+constexpr auto MakeSortedTable ()
+{
+   static_assert (!std::is_same_v <typename SequenceT::type, tmp::TypeSequence<>>, "MakeSortedTable needs at least one type to deduce the value type from");
+
+   constexpr auto values = tmp::TypeToValueConverter <detail::Identity, SequenceT>::value;
+
+   auto array = std::apply ([] (auto... value) {return std::array <std::common_type_t <decltype (value)...>, sizeof... (value)> {value...};}, values);
+
+   using ValueT = typename decltype (array)::value_type;
+
+   return SortedTable <ValueT, std::tuple_size_v <decltype (values)>, std::conditional_t <std::is_void_v<CompareT>, std::less<ValueT>, CompareT>> (array);
+}
+
+}
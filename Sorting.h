@@ -2,20 +2,59 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
+#include "TemplateMetaProgramming.h"
+
 namespace utilities
 {
 
 template <typename IteratorT> using IteratorValueT = typename std::iterator_traits<IteratorT>::value_type;
 template <typename IteratorT> using DefaultCompareT = std::less< IteratorValueT<IteratorT> >;
 
+// std::swap, std::copy and std::move only become constexpr in C++20; the sorts below use these
+// instead so that they can run at compile time.
+template <typename T>
+constexpr void Swap (T & first, T & second)
+{
+   T moved = std::move (first);
+   first = std::move (second);
+   second = std::move (moved);
+}
+
+template <typename IteratorT, typename OutputIteratorT>
+constexpr OutputIteratorT Copy (IteratorT first, IteratorT const last, OutputIteratorT output)
+{
+   for (; first != last; ++first, ++output) *output = *first;
+
+   return output;
+}
+
+template <typename IteratorT, typename OutputIteratorT>
+constexpr OutputIteratorT Move (IteratorT first, IteratorT const last, OutputIteratorT output)
+{
+   for (; first != last; ++first, ++output) *output = std::move (*first);
+
+   return output;
+}
+
+// Whether BufferIteratorT can serve as scratch space for sorting a range of IteratorT.
+template <typename BufferIteratorT, typename IteratorT, typename = void>
+constexpr bool IsBufferFor = false;
+
+template <typename BufferIteratorT, typename IteratorT>
+constexpr bool IsBufferFor <BufferIteratorT, IteratorT, std::void_t <typename std::iterator_traits<BufferIteratorT>::iterator_category>>
+   = std::is_assignable_v <typename std::iterator_traits<BufferIteratorT>::reference, IteratorValueT<IteratorT> &&>;
+
 #pragma region Heap Sort
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void HeapInsert (IteratorT first, IteratorT inserted, typename std::iterator_traits<IteratorT>::difference_type distanceToInserted, CompareT const & compare = CompareT ())
+constexpr void HeapInsert (IteratorT first, IteratorT inserted, typename std::iterator_traits<IteratorT>::difference_type distanceToInserted, CompareT const & compare = CompareT ())
 {
    if (inserted == first) return;
 
@@ -25,19 +64,19 @@ void HeapInsert (IteratorT first, IteratorT inserted, typename std::iterator_tra
 
    if (compare (*inserted, *parent)) return;
 
-   std::swap (*parent, *inserted);
+   Swap (*parent, *inserted);
 
    HeapInsert (first, parent, distanceToParent, compare);
 }
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void HeapInsert(IteratorT first, IteratorT inserted, CompareT const & compare = CompareT())
+constexpr void HeapInsert(IteratorT first, IteratorT inserted, CompareT const & compare = CompareT())
 {
    HeapInsert(first, inserted, std::distance (first, inserted), compare);
 }
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void HeapMake (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+constexpr void HeapMake (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
 {
    for (auto current = std::make_pair (first, 0); current.first != last; ++current.first, ++current.second)
    {
@@ -46,7 +85,7 @@ void HeapMake (IteratorT first, IteratorT last, CompareT const & compare = Compa
 }
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void HeapInsertTop (IteratorT const first, size_t distToParent, size_t const distToEnd, CompareT const & compare = CompareT ())
+constexpr void HeapInsertTop (IteratorT const first, size_t distToParent, size_t const distToEnd, CompareT const & compare = CompareT ())
 {
    if (distToParent >= distToEnd) return;
 
@@ -70,14 +109,14 @@ void HeapInsertTop (IteratorT const first, size_t distToParent, size_t const dis
 
    if (compare (*parent, *nextParent))
    {
-      std::swap (*parent, *nextParent);
+      Swap (*parent, *nextParent);
       HeapInsertTop (first, distToNextParent, distToEnd, compare);
    }
 }
 
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-IteratorT HeapRemoveTop (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+constexpr IteratorT HeapRemoveTop (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
 {
    if (first == last) return last;
 
@@ -85,7 +124,7 @@ IteratorT HeapRemoveTop (IteratorT first, IteratorT last, CompareT const & compa
 
    last = std::prev (last);
 
-   std::swap (*first, *last);
+   Swap (*first, *last);
 
    HeapInsertTop (first, 0, std::distance (first, last), compare);
 
@@ -93,7 +132,7 @@ IteratorT HeapRemoveTop (IteratorT first, IteratorT last, CompareT const & compa
 }
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void HeapSort (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+constexpr void HeapSort (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
 {
    while (first != last)
    {
@@ -105,33 +144,28 @@ void HeapSort (IteratorT first, IteratorT last, CompareT const & compare = Compa
 
 #pragma region Merge Sort
 
-template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void Merge (IteratorT first1, IteratorT const last1,
+template < typename IteratorT, typename OutputIteratorT, typename CompareT = DefaultCompareT<IteratorT> >
+constexpr void Merge (IteratorT first1, IteratorT const last1,
             IteratorT first2, IteratorT const last2,
-            IteratorT firstOutput,
+            OutputIteratorT firstOutput,
             CompareT const & compare = CompareT ())
 {
-   if (first1 == last1)
+   // Ties are taken from the first range, which keeps merging stable.
+   while (first1 != last1 && first2 != last2)
    {
-      std::copy (first2, last2, firstOutput);
-      return;
-   }
+      IteratorT & current = compare (*first2, *first1) ? first2 : first1;
 
-   if (first2 == last2)
-   {
-      std::copy (first1, last1, firstOutput);
-      return;
+      *firstOutput++ = std::move (*current++);
    }
 
-   IteratorT & current = compare (*first1, *first2) ? first1 : first2;
-
-   *firstOutput++ = *current++;
-
-   Merge (first1, last1, first2, last2, firstOutput, compare);
+   Move (first2, last2, Move (first1, last1, firstOutput));
 }
 
-template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void MergeSort (IteratorT first, IteratorT const last, IteratorT firstBuffer, CompareT const & compare = CompareT ())
+// Sorts with the caller's scratch space: firstBuffer must have room for as many elements as
+// [first, last). Allocates nothing and runs at compile time when the range and buffer allow it.
+template < typename IteratorT, typename BufferIteratorT, typename CompareT = DefaultCompareT<IteratorT>,
+           typename = std::enable_if_t <IsBufferFor <BufferIteratorT, IteratorT>> >
+constexpr void MergeSort (IteratorT first, IteratorT const last, BufferIteratorT firstBuffer, CompareT const & compare = CompareT ())
 {
    if (first == last || last == std::next (first)) return;
 
@@ -146,10 +180,11 @@ void MergeSort (IteratorT first, IteratorT const last, IteratorT firstBuffer, Co
 
    Merge (first, middle, middle, last, firstBuffer, compare);
 
-   std::copy (firstBuffer, lastBuffer, first);
+   Move (firstBuffer, lastBuffer, first);
 }
 
-template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
+template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT>,
+           typename = std::enable_if_t <!IsBufferFor <CompareT, IteratorT>> >
 void MergeSort (IteratorT first, IteratorT const last, CompareT const & compare = CompareT ())
 {
    auto size = std::distance (first, last);
@@ -160,16 +195,16 @@ void MergeSort (IteratorT first, IteratorT const last, CompareT const & compare
    auto tmpMiddle = std::next (tmpContainer.begin (), tmpContainer.size () / 2);
    auto tmpLast = std::next (tmpContainer.begin(), size);
 
-   std::copy (middle, last, tmpContainer.begin ());
+   std::move (middle, last, tmpContainer.begin ());
 
    MergeSort (first, middle, middle, compare);
    MergeSort (tmpContainer.begin(), tmpMiddle, tmpMiddle, compare);
 
-   std::copy (tmpContainer.begin(), tmpMiddle, middle);
+   std::move (tmpContainer.begin(), tmpMiddle, middle);
 
    Merge (first, middle, middle, last, tmpContainer.begin (), compare);
 
-   std::copy (tmpContainer.begin (), tmpLast, first);
+   std::move (tmpContainer.begin (), tmpLast, first);
 }
 
 
@@ -178,30 +213,30 @@ void MergeSort (IteratorT first, IteratorT const last, CompareT const & compare
 #pragma region Quick Sort
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-IteratorValueT<IteratorT> MedianOfThree (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+constexpr IteratorValueT<IteratorT> MedianOfThree (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
 {
    auto size = std::distance (first, last);
 
    if (size == 1) return *first;
 
-   if (size == 2) return std::max (*first, *std::next (first));
+   if (size == 2) return compare (*first, *std::next (first)) ? *std::next (first) : *first;
 
    auto middle = std::next (first, size / 2);
 
    std::array <IteratorValueT<IteratorT>, 3> choices {*first, *middle, *(std::prev (last))};
 
-   if (!compare (choices [0], choices [1])) std::swap (choices [0], choices [1]);
+   if (!compare (choices [0], choices [1])) Swap (choices [0], choices [1]);
    if (!compare (choices [1], choices [2]))
    {
-      std::swap (choices [1], choices [2]);
-      if (!compare (choices [0], choices [1])) std::swap (choices [0], choices [1]);
+      Swap (choices [1], choices [2]);
+      if (!compare (choices [0], choices [1])) Swap (choices [0], choices [1]);
    }
 
    return choices [1];
 }
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-IteratorT MinElement (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+constexpr IteratorT MinElement (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
 {
    if (first == last) return first;
 
@@ -216,7 +251,7 @@ IteratorT MinElement (IteratorT first, IteratorT last, CompareT const & compare
 }
 
 template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
-void QuickSort (IteratorT first, IteratorT const last, CompareT const & compare = CompareT ())
+constexpr void QuickSort (IteratorT first, IteratorT const last, CompareT const & compare = CompareT ())
 {
    if (first == last || last == std::next (first)) return;
 
@@ -229,7 +264,7 @@ void QuickSort (IteratorT first, IteratorT const last, CompareT const & compare
    {
       if (!compare (*itUnder, median))
       {
-         std::swap (*itUnder, *itAbove);
+         Swap (*itUnder, *itAbove);
 
          --itAbove;
 
@@ -244,7 +279,7 @@ void QuickSort (IteratorT first, IteratorT const last, CompareT const & compare
    if (itUnder == first)
    {
       auto itMin = MinElement (first, last, compare);
-      std::swap (*first, *itMin);
+      Swap (*first, *itMin);
       itUnder = std::next (first);
    }
 
@@ -252,6 +287,312 @@ void QuickSort (IteratorT first, IteratorT const last, CompareT const & compare
    QuickSort (itUnder, last, compare);
 }
 
+// Quicksort for forward iterators that moves values through swaps alone. The middle element is the
+// pivot, so presorted input stays O(n log n); a three-way partition keeps runs of equal values
+// linear, and looping on the larger part bounds the recursion depth to log2 (n).
+template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
+constexpr void ForwardQuickSort (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+{
+   auto size = std::distance (first, last);
+
+   while (size > 1)
+   {
+      Swap (*first, *std::next (first, size / 2));
+
+      // With the pivot in *first: [first + 1, less) < pivot, [less, equal) == pivot, [equal, current) > pivot.
+      auto beforeLess = first;
+      auto less = std::next (first);
+      auto equal = less;
+
+      decltype (size) lessCount = 0;
+      decltype (size) equalCount = 1;
+
+      for (auto current = less; current != last; ++current)
+      {
+         if (compare (*current, *first))
+         {
+            if (equal != current) Swap (*equal, *current);
+            if (less != equal) Swap (*less, *equal);
+
+            beforeLess = less++;
+            ++equal;
+            ++lessCount;
+         }
+         else if (!compare (*first, *current))
+         {
+            if (equal != current) Swap (*equal, *current);
+
+            ++equal;
+            ++equalCount;
+         }
+      }
+
+      // Now [first, beforeLess) < pivot and [beforeLess, equal) == pivot.
+      if (beforeLess != first) Swap (*first, *beforeLess);
+
+      auto const greaterCount = size - lessCount - equalCount;
+
+      if (lessCount < greaterCount)
+      {
+         ForwardQuickSort (first, beforeLess, compare);
+         first = equal;
+         size = greaterCount;
+      }
+      else
+      {
+         ForwardQuickSort (equal, last, compare);
+         last = beforeLess;
+         size = lessCount;
+      }
+   }
+}
+
+
+#pragma endregion
+
+#pragma region Radix Sort
+
+// LSD radix sort, stable, in ascending order of the integral key (value) of every value: one counting
+// pass builds the histograms of every key byte, then each byte on which the keys differ is scattered
+// stably into a buffer and back. Only the key's bytes are visited, so a narrow key extracted from a
+// wide value costs one pass per key byte.
+template <typename IteratorT, typename KeyFunctionT>
+void RadixSort (IteratorT first, IteratorT last, KeyFunctionT const & key)
+{
+   using ValueT = IteratorValueT<IteratorT>;
+   using RawKeyT = std::decay_t <std::invoke_result_t <KeyFunctionT const &, ValueT const &>>;
+   using KeyT   = std::make_unsigned_t<RawKeyT>;
+
+   static_assert (std::is_integral_v<RawKeyT> && !std::is_same_v<RawKeyT, bool>, "RadixSort sorts on integral keys");
+
+   auto const size = static_cast<std::size_t> (std::distance (first, last));
+
+   if (size < 2) return;
+
+   // Flipping the sign bit maps the signed order onto the unsigned one.
+   constexpr KeyT signFlip = std::is_signed_v<RawKeyT> ? static_cast<KeyT> (KeyT (1) << (8 * sizeof (KeyT) - 1)) : KeyT (0);
+
+   auto digit = [&key] (ValueT const & value, std::size_t byte) {return static_cast<std::size_t> ((static_cast<KeyT> (static_cast<KeyT> (key (value)) ^ signFlip) >> (8 * byte)) & 0xFF);};
+
+   std::array <std::array <std::size_t, 256>, sizeof (KeyT)> counts {};
+
+   for (auto current = first; current != last; ++current)
+   {
+      for (std::size_t byte = 0; byte < sizeof (KeyT); ++byte) ++counts [byte][digit (*current, byte)];
+   }
+
+   std::vector<ValueT> buffer (size);
+
+   auto scatter = [&digit] (auto from, auto fromLast, auto to, std::size_t byte, std::array <std::size_t, 256> & offsets)
+   {
+      for (; from != fromLast; ++from) to [offsets [digit (*from, byte)]++] = *from;
+   };
+
+   bool inBuffer = false;
+
+   for (std::size_t byte = 0; byte < sizeof (KeyT); ++byte)
+   {
+      auto & offsets = counts [byte];
+
+      if (offsets [digit (*first, byte)] == size) continue;
+
+      std::size_t total = 0;
+
+      for (auto & offset : offsets)
+      {
+         auto const count = offset;
+         offset = total;
+         total += count;
+      }
+
+      if (inBuffer) scatter (buffer.begin (), buffer.end (), first, byte, offsets);
+      else          scatter (first, last, buffer.begin (), byte, offsets);
+
+      inBuffer = !inBuffer;
+   }
+
+   if (inBuffer) std::copy (buffer.begin (), buffer.end (), first);
+}
+
+// Sorts integral values on themselves.
+template <typename IteratorT>
+void RadixSort (IteratorT first, IteratorT last)
+{
+   RadixSort (first, last, [] (IteratorValueT<IteratorT> value) {return value;});
+}
+
+#pragma endregion
+
+#pragma region Sort dispatch
+
+template <typename IteratorT, typename CategoryT>
+constexpr bool IteratorIs = std::is_base_of_v <CategoryT, typename std::iterator_traits<IteratorT>::iterator_category>;
+
+// Strings and string views: costly comparisons, cheap moves.
+template <typename T, typename = void>
+struct IsStringLike : std::false_type {};
+
+template <typename T>
+struct IsStringLike <T, std::void_t <typename T::traits_type, typename T::value_type>> : std::true_type {};
+
+template <typename CompareT, typename ValueT>
+constexpr bool IsDefaultCompare = std::is_same_v <CompareT, std::less<ValueT>> || std::is_same_v <CompareT, std::less<>>;
+
+namespace sort_engines
+{
+
+// Integral keys in their natural order: no comparisons at all, linear time on large ranges.
+struct RadixSorter
+{
+   template <typename IteratorT, typename CompareT, typename ValueT = IteratorValueT<IteratorT>>
+   static constexpr bool eligible = IteratorIs <IteratorT, std::random_access_iterator_tag>
+                                 && std::is_integral_v<ValueT> && !std::is_same_v<ValueT, bool>
+                                 && IsDefaultCompare <CompareT, ValueT>;
+
+   // Below this size the histogram passes cost more than they save.
+   static constexpr std::size_t f_threshold = 64;
+
+   template <typename IteratorT, typename CompareT>
+   static void sort (IteratorT first, IteratorT last, CompareT const & compare)
+   {
+      if (static_cast<std::size_t> (std::distance (first, last)) < f_threshold) QuickSort (first, last, compare);
+      else RadixSort (first, last);
+   }
+};
+
+// Move-only values: sorted in place through swaps alone.
+struct HeapSorter
+{
+   template <typename IteratorT, typename CompareT, typename ValueT = IteratorValueT<IteratorT>>
+   static constexpr bool eligible = IteratorIs <IteratorT, std::random_access_iterator_tag> && !std::is_copy_constructible_v<ValueT>;
+
+   template <typename IteratorT, typename CompareT>
+   static void sort (IteratorT first, IteratorT last, CompareT const & compare)
+   {
+      HeapMake (first, last, compare);
+      HeapSort (first, last, compare);
+   }
+};
+
+// Forward-only ranges, which cannot be partitioned from both ends but only ever step forward while
+// merging, and string-like values, for which merging's n log2 n comparisons beat quicksort's 1.39 n log2 n.
+// Values are moved, never copied, in and out of the scratch vector.
+struct MergeSorter
+{
+   template <typename IteratorT, typename CompareT, typename ValueT = IteratorValueT<IteratorT>>
+   static constexpr bool eligible = IteratorIs <IteratorT, std::forward_iterator_tag>
+                                 && (!IteratorIs <IteratorT, std::bidirectional_iterator_tag> || IsStringLike<ValueT>::value)
+                                 && std::is_move_assignable_v<ValueT> && std::is_default_constructible_v<ValueT>;
+
+   template <typename IteratorT, typename CompareT>
+   static void sort (IteratorT first, IteratorT last, CompareT const & compare)
+   {
+      MergeSort (first, last, compare);
+   }
+};
+
+// Everything else.
+struct QuickSorter
+{
+   template <typename IteratorT, typename CompareT, typename ValueT = IteratorValueT<IteratorT>>
+   static constexpr bool eligible = IteratorIs <IteratorT, std::bidirectional_iterator_tag> && std::is_copy_constructible_v<ValueT>;
+
+   template <typename IteratorT, typename CompareT>
+   static void sort (IteratorT first, IteratorT last, CompareT const & compare)
+   {
+      QuickSort (first, last, compare);
+   }
+};
+
+// Fallback for the rest, e.g. move-only values in a list: swaps alone, stepping forward only.
+struct ForwardSorter
+{
+   template <typename IteratorT, typename CompareT, typename ValueT = IteratorValueT<IteratorT>>
+   static constexpr bool eligible = IteratorIs <IteratorT, std::forward_iterator_tag>
+                                 && std::is_move_constructible_v<ValueT> && std::is_move_assignable_v<ValueT>;
+
+   template <typename IteratorT, typename CompareT>
+   static void sort (IteratorT first, IteratorT last, CompareT const & compare)
+   {
+      ForwardQuickSort (first, last, compare);
+   }
+};
+
+}
+
+// Candidate engines, by decreasing preference: Sort uses the first one eligible for its arguments.
+using SortEngines = tmp::TypeSequence <sort_engines::RadixSorter, sort_engines::HeapSorter, sort_engines::MergeSorter,
+                                       sort_engines::QuickSorter, sort_engines::ForwardSorter>;
+
+template < typename IteratorT, typename CompareT >
+struct SortDispatch
+{
+   template <typename EngineT>
+   using Eligible = std::bool_constant <EngineT::template eligible <IteratorT, CompareT>>;
+
+   // One flag per engine, in SortEngines order.
+   static constexpr auto table = tmp::TypeToValueConverter <Eligible, SortEngines>::value;
+
+   static constexpr std::size_t index = std::apply ([] (auto... eligible)
+   {
+      std::size_t result = 0;
+
+      for (bool flag : {bool (eligible)...})
+      {
+         if (flag) break;
+         ++result;
+      }
+
+      return result;
+   }, table);
+
+   static_assert (index < std::tuple_size_v <decltype (table)>, "no sort engine accepts these iterators and values");
+
+   template <typename... EnginesT>
+   static auto Pick (tmp::TypeSequence<EnginesT...>) -> std::tuple_element_t <index, std::tuple<EnginesT...>>;
+
+   using type = decltype (Pick (SortEngines {}));
+};
+
+// Sorts [first, last) with the engine best suited, at compile time, to the iterator category, the
+// value type and the comparator. Not stable.
+template < typename IteratorT, typename CompareT = DefaultCompareT<IteratorT> >
+void Sort (IteratorT first, IteratorT last, CompareT const & compare = CompareT ())
+{
+   SortDispatch <IteratorT, CompareT>::type::sort (first, last, compare);
+}
 
 #pragma endregion
-}
\ No newline at end of file
+
+#pragma region Sorted search
+
+// Lower and upper bound on a sorted contiguous range by branchless halving: the trip count depends
+// on the size only, and the compiler turns the step into a conditional move.
+template < typename T, typename KeyT, typename CompareT >
+constexpr T const * BranchlessLowerBound (T const * first, T const * last, KeyT const & key, CompareT const & compare)
+{
+   if (first == last) return first;
+
+   for (auto length = static_cast<std::size_t> (last - first); length > 1; length -= length / 2)
+   {
+      first = compare (first [length / 2], key) ? first + length / 2 : first;
+   }
+
+   return first + compare (*first, key);
+}
+
+template < typename T, typename KeyT, typename CompareT >
+constexpr T const * BranchlessUpperBound (T const * first, T const * last, KeyT const & key, CompareT const & compare)
+{
+   if (first == last) return first;
+
+   for (auto length = static_cast<std::size_t> (last - first); length > 1; length -= length / 2)
+   {
+      first = compare (key, first [length / 2]) ? first : first + length / 2;
+   }
+
+   return first + !compare (key, *first);
+}
+
+#pragma endregion
+}
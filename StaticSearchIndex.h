@@ -0,0 +1,444 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <vector>
+
+#include "BinarySearchTree.h"
+
+namespace utilities
+{
+
+namespace detail
+{
+
+inline unsigned TrailingOnes (std::size_t value) noexcept
+{
+#if defined (__GNUC__) || defined (__clang__)
+   return ~value ? static_cast<unsigned> (__builtin_ctzll (~static_cast<unsigned long long> (value))) : 64u;
+#else
+   unsigned result = 0;
+   for (; value & 1; value >>= 1) ++result;
+   return result;
+#endif
+}
+
+inline void Prefetch (void const * address) noexcept
+{
+#if defined (__GNUC__) || defined (__clang__)
+   __builtin_prefetch (address);
+#else
+   (void) address;
+#endif
+}
+
+constexpr std::size_t f_cacheLineSize = 64;
+
+// Allocates on cache line boundaries, so that line-sized blocks of an array really are cache lines.
+template <typename T>
+struct CacheLineAllocator
+{
+   using value_type = T;
+
+   CacheLineAllocator () = default;
+
+   template <typename U>
+   CacheLineAllocator (CacheLineAllocator<U> const &) noexcept {}
+
+   T *   allocate    (std::size_t count) {return static_cast<T *> (::operator new (count * sizeof (T), std::align_val_t {f_cacheLineSize}));}
+
+   void  deallocate  (T * pointer, std::size_t) noexcept {::operator delete (pointer, std::align_val_t {f_cacheLineSize});}
+
+   template <typename U>
+   bool  operator == (CacheLineAllocator<U> const &) const noexcept {return true;}
+
+   template <typename U>
+   bool  operator != (CacheLineAllocator<U> const &) const noexcept {return false;}
+};
+
+template <typename T>
+using CacheLineVector = std::vector <T, CacheLineAllocator<T>>;
+
+}
+
+#pragma region Eytzinger layout
+
+// Read-only ordered set stored as an implicit binary tree in breadth-first (Eytzinger) order:
+// the children of slot k are 2k and 2k + 1, so the top levels share a few cache lines and the
+// descent is a branch-free index computation. Built once from a sorted range in O(n).
+template < typename PayloadT, typename CompareT = std::less <PayloadT> >
+class StaticSearchIndex
+{
+public:
+
+   using size_type = std::size_t;
+
+   class const_iterator;
+
+   using iterator = const_iterator;
+
+   #pragma region Construction
+
+   StaticSearchIndex () = default;
+
+   // [first, last) must be sorted according to CompareT.
+   template <typename IteratorT>
+   StaticSearchIndex (IteratorT first, IteratorT last);
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   const_iterator begin    () const noexcept;
+   const_iterator cbegin   () const noexcept {return begin ();}
+   const_iterator end      () const noexcept {return const_iterator (this, 0);}
+   const_iterator cend     () const noexcept {return end ();}
+
+   size_type      size     () const noexcept {return i_size;}
+
+   bool           empty    () const noexcept {return i_size == 0;}
+
+   const_iterator find        (PayloadT const & value) const noexcept;
+
+   const_iterator lower_bound (PayloadT const & value) const noexcept;
+
+   const_iterator upper_bound (PayloadT const & value) const noexcept;
+
+   #pragma endregion
+
+   #pragma region const_iterator
+
+   // In-order walk over the implicit tree: amortized O(1) per step.
+   class const_iterator
+   {
+   public:
+
+      using iterator_category = std::forward_iterator_tag;
+
+      using value_type        = PayloadT;
+
+      using difference_type   = std::ptrdiff_t;
+
+      using reference         = PayloadT const &;
+
+      using pointer           = PayloadT const *;
+
+      const_iterator () : i_index (nullptr), i_slot (0) {}
+
+      reference         operator *  () const {return i_index->i_data [i_slot];}
+
+      pointer           operator -> () const {return &(i_index->i_data [i_slot]);}
+
+      const_iterator &  operator ++ () {i_slot = i_index->Next (i_slot); return *this;}
+
+      const_iterator    operator ++ (int) {auto result = *this; ++(*this); return result;}
+
+      bool              operator == (const_iterator const & it) const {return i_slot == it.i_slot;}
+
+      bool              operator != (const_iterator const & it) const {return !(*this == it);}
+
+   private:
+
+      friend StaticSearchIndex <PayloadT, CompareT>;
+
+      const_iterator (StaticSearchIndex const * index, size_type slot) : i_index (index), i_slot (slot) {}
+
+      StaticSearchIndex const *  i_index;
+      size_type                  i_slot;
+   };
+
+   #pragma endregion
+
+private:
+
+   // Slot of the in-order successor of slot, 0 past the last element.
+   size_type   Next     (size_type slot) const noexcept;
+
+   size_type   First    () const noexcept;
+
+   // Slot holding the first element for which goRight (element) is false, 0 if there is none.
+   template <typename GoRightT>
+   size_type   Descend  (GoRightT goRight) const noexcept;
+
+   // Elements per cache line: slot k * f_lineElements starts the block holding the descendants of
+   // slot k four levels down (for 16 elements per line), which is prefetched while the upper levels
+   // are compared. i_data is line aligned, so when the element size divides the line, that block
+   // is exactly one cache line.
+   static constexpr size_type f_lineElements = std::max <size_type> (detail::f_cacheLineSize / sizeof (PayloadT), 1);
+
+   static const CompareT f_compare;
+
+   // Slot 0 is unused so that the children of slot k are 2k and 2k + 1.
+   detail::CacheLineVector<PayloadT>   i_data;
+   size_type                           i_size = 0;
+};
+
+template < typename PayloadT, typename CompareT >
+const CompareT StaticSearchIndex <PayloadT, CompareT>::f_compare {};
+
+template < typename PayloadT, typename CompareT >
+template < typename IteratorT >
+StaticSearchIndex <PayloadT, CompareT>::StaticSearchIndex (IteratorT first, IteratorT last)
+: i_size (static_cast<size_type> (std::distance (first, last)))
+{
+   if (!i_size) return;
+
+   i_data.assign (i_size + 1, *first);
+
+   for (auto slot = First (); slot; slot = Next (slot), ++first) i_data [slot] = *first;
+}
+
+template < typename PayloadT, typename CompareT >
+typename StaticSearchIndex <PayloadT, CompareT>::size_type StaticSearchIndex <PayloadT, CompareT>::First () const noexcept
+{
+   size_type slot = i_size ? 1 : 0;
+
+   while (slot && 2 * slot <= i_size) slot *= 2;
+
+   return slot;
+}
+
+template < typename PayloadT, typename CompareT >
+typename StaticSearchIndex <PayloadT, CompareT>::size_type StaticSearchIndex <PayloadT, CompareT>::Next (size_type slot) const noexcept
+{
+   if (2 * slot + 1 <= i_size)
+   {
+      slot = 2 * slot + 1;
+
+      while (2 * slot <= i_size) slot *= 2;
+
+      return slot;
+   }
+
+   // Climb while slot is a right child, then once more to the parent of the left child.
+   return slot >> (detail::TrailingOnes (slot) + 1);
+}
+
+template < typename PayloadT, typename CompareT >
+template < typename GoRightT >
+typename StaticSearchIndex <PayloadT, CompareT>::size_type StaticSearchIndex <PayloadT, CompareT>::Descend (GoRightT goRight) const noexcept
+{
+   auto const data = i_data.data ();
+
+   size_type slot = 1;
+
+   while (slot <= i_size)
+   {
+      detail::Prefetch (reinterpret_cast<void const *> (reinterpret_cast<std::uintptr_t> (data) + slot * f_lineElements * sizeof (PayloadT)));
+
+      slot = 2 * slot + static_cast<size_type> (goRight (data [slot]));
+   }
+
+   // The path ends with the answer's slot followed by one left turn and only right turns after it.
+   return slot >> (detail::TrailingOnes (slot) + 1);
+}
+
+template < typename PayloadT, typename CompareT >
+typename StaticSearchIndex <PayloadT, CompareT>::const_iterator StaticSearchIndex <PayloadT, CompareT>::begin () const noexcept
+{
+   return const_iterator (this, First ());
+}
+
+template < typename PayloadT, typename CompareT >
+typename StaticSearchIndex <PayloadT, CompareT>::const_iterator StaticSearchIndex <PayloadT, CompareT>::lower_bound (PayloadT const & value) const noexcept
+{
+   return const_iterator (this, Descend ([&value] (PayloadT const & element) {return f_compare (element, value);}));
+}
+
+template < typename PayloadT, typename CompareT >
+typename StaticSearchIndex <PayloadT, CompareT>::const_iterator StaticSearchIndex <PayloadT, CompareT>::upper_bound (PayloadT const & value) const noexcept
+{
+   return const_iterator (this, Descend ([&value] (PayloadT const & element) {return !f_compare (value, element);}));
+}
+
+template < typename PayloadT, typename CompareT >
+typename StaticSearchIndex <PayloadT, CompareT>::const_iterator StaticSearchIndex <PayloadT, CompareT>::find (PayloadT const & value) const noexcept
+{
+   auto result = lower_bound (value);
+
+   return result != end () && !f_compare (value, *result) ? result : end ();
+}
+
+#pragma endregion
+
+#pragma region B+ layout
+
+// Read-only ordered set laid out as a static B+ tree: the elements stay in one sorted array (so
+// iteration is a pointer walk) and are indexed by layers of BlockSizeV-key nodes. Both arrays are
+// line aligned, so with the default BlockSizeV every node and leaf block is one cache line. A node is searched by counting its keys below the value with a fixed
+// trip count and no branches, which compilers turn into SIMD compares for arithmetic keys.
+template < typename PayloadT, typename CompareT = std::less <PayloadT>, std::size_t BlockSizeV = std::max <std::size_t> (detail::f_cacheLineSize / sizeof (PayloadT), 2) >
+class StaticBlockSearchIndex
+{
+public:
+
+   using size_type         = std::size_t;
+
+   using const_iterator    = PayloadT const *;
+
+   using iterator          = const_iterator;
+
+   #pragma region Construction
+
+   StaticBlockSearchIndex () = default;
+
+   // [first, last) must be sorted according to CompareT.
+   template <typename IteratorT>
+   StaticBlockSearchIndex (IteratorT first, IteratorT last);
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   const_iterator begin    () const noexcept {return i_leaves.data ();}
+   const_iterator cbegin   () const noexcept {return begin ();}
+   const_iterator end      () const noexcept {return i_leaves.data () + i_size;}
+   const_iterator cend     () const noexcept {return end ();}
+
+   size_type      size     () const noexcept {return i_size;}
+
+   bool           empty    () const noexcept {return i_size == 0;}
+
+   const_iterator find        (PayloadT const & value) const noexcept;
+
+   const_iterator lower_bound (PayloadT const & value) const noexcept;
+
+   const_iterator upper_bound (PayloadT const & value) const noexcept;
+
+   #pragma endregion
+
+private:
+
+   static constexpr size_type f_fanOut = BlockSizeV + 1;
+
+   // Number of keys in block for which goRight (key) holds.
+   template <typename GoRightT>
+   static size_type  CountInBlock (PayloadT const * block, GoRightT goRight) noexcept;
+
+   template <typename GoRightT>
+   const_iterator    Descend  (GoRightT goRight) const noexcept;
+
+   static const CompareT f_compare;
+
+   // Sorted elements padded with copies of the largest one up to a whole number of blocks.
+   detail::CacheLineVector<PayloadT>   i_leaves;
+
+   // Internal layers, root first. Key i of a node is the largest element under its child i;
+   // missing children are padded with the largest element too.
+   detail::CacheLineVector<PayloadT>   i_nodes;
+   std::vector<size_type>              i_layerOffsets;
+   size_type                           i_size = 0;
+};
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+const CompareT StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::f_compare {};
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+template < typename IteratorT >
+StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::StaticBlockSearchIndex (IteratorT first, IteratorT last)
+: i_leaves (first, last), i_size (i_leaves.size ())
+{
+   if (!i_size) return;
+
+   auto const largest = i_leaves.back ();
+
+   i_leaves.resize ((i_size + BlockSizeV - 1) / BlockSizeV * BlockSizeV, largest);
+
+   // Build the layers bottom up: maxima [c] is the largest element under block c of the layer below.
+   std::vector<PayloadT> maxima;
+
+   for (size_type block = 0; block < i_leaves.size () / BlockSizeV; ++block) maxima.push_back (i_leaves [block * BlockSizeV + BlockSizeV - 1]);
+
+   std::vector<std::vector<PayloadT>> layers;
+
+   while (maxima.size () > 1)
+   {
+      auto const blocks = (maxima.size () + f_fanOut - 1) / f_fanOut;
+
+      std::vector<PayloadT> layer (blocks * BlockSizeV, largest);
+      std::vector<PayloadT> nextMaxima;
+
+      for (size_type block = 0; block < blocks; ++block)
+      {
+         for (size_type key = 0; key < BlockSizeV && block * f_fanOut + key < maxima.size (); ++key)
+         {
+            layer [block * BlockSizeV + key] = maxima [block * f_fanOut + key];
+         }
+
+         nextMaxima.push_back (maxima [std::min ((block + 1) * f_fanOut, maxima.size ()) - 1]);
+      }
+
+      layers.push_back (std::move (layer));
+      maxima.swap (nextMaxima);
+   }
+
+   for (auto layer = layers.rbegin (); layer != layers.rend (); ++layer)
+   {
+      i_layerOffsets.push_back (i_nodes.size ());
+      i_nodes.insert (i_nodes.end (), layer->begin (), layer->end ());
+   }
+}
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+template < typename GoRightT >
+typename StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::size_type StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::CountInBlock (PayloadT const * block, GoRightT goRight) noexcept
+{
+   size_type count = 0;
+
+   for (size_type key = 0; key < BlockSizeV; ++key) count += static_cast<size_type> (goRight (block [key]));
+
+   return count;
+}
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+template < typename GoRightT >
+typename StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::const_iterator StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::Descend (GoRightT goRight) const noexcept
+{
+   // Past the largest element; otherwise the answer exists and padding keys never go right,
+   // so every descent below stays within real children.
+   if (!i_size || goRight (i_leaves.back ())) return end ();
+
+   size_type block = 0;
+
+   for (auto offset : i_layerOffsets)
+   {
+      block = block * f_fanOut + CountInBlock (i_nodes.data () + offset + block * BlockSizeV, goRight);
+   }
+
+   return begin () + block * BlockSizeV + CountInBlock (i_leaves.data () + block * BlockSizeV, goRight);
+}
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+typename StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::const_iterator StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::lower_bound (PayloadT const & value) const noexcept
+{
+   return Descend ([&value] (PayloadT const & element) {return f_compare (element, value);});
+}
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+typename StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::const_iterator StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::upper_bound (PayloadT const & value) const noexcept
+{
+   return Descend ([&value] (PayloadT const & element) {return !f_compare (value, element);});
+}
+
+template < typename PayloadT, typename CompareT, std::size_t BlockSizeV >
+typename StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::const_iterator StaticBlockSearchIndex <PayloadT, CompareT, BlockSizeV>::find (PayloadT const & value) const noexcept
+{
+   auto result = lower_bound (value);
+
+   return result != end () && !f_compare (value, *result) ? result : end ();
+}
+
+#pragma endregion
+
+// Read-only snapshot of tree, for lookup-heavy phases.
+template <typename PayloadT, typename CompareT, typename... OptionsT>
+StaticSearchIndex<PayloadT, CompareT> Freeze (BinarySearchTree<PayloadT, CompareT, OptionsT...> const & tree)
+{
+   return StaticSearchIndex<PayloadT, CompareT> (tree.begin (), tree.end ());
+}
+
+}
@@ -0,0 +1,399 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Sorting.h"
+#include "TemplateMetaProgramming.h"
+
+namespace utilities
+{
+
+// Contiguous view of one field of every record.
+template <typename T>
+class ColumnView
+{
+public:
+
+   using value_type  = std::remove_const_t<T>;
+
+   using size_type   = std::size_t;
+
+   using iterator    = T *;
+
+   ColumnView (T * first, size_type size) noexcept : i_first (first), i_size (size) {}
+
+   iterator    begin () const noexcept {return i_first;}
+   iterator    end   () const noexcept {return i_first + i_size;}
+
+   T *         data  () const noexcept {return i_first;}
+
+   size_type   size  () const noexcept {return i_size;}
+
+   bool        empty () const noexcept {return i_size == 0;}
+
+   T &         operator [] (size_type index) const noexcept {return i_first [index];}
+
+private:
+
+   T *         i_first;
+   size_type   i_size;
+};
+
+// Proxy for one record of an SoA: a tuple of references into its columns. Assigning to it writes
+// the referenced fields, and Swap exchanges them, so that the Sorting.h algorithms can permute
+// records through SoA iterators. It converts to value_type, a tuple holding a copy of the record.
+template <typename... FieldsT>
+class RowReference
+{
+public:
+
+   using value_type = std::tuple <std::remove_const_t<FieldsT>...>;
+
+   explicit RowReference (FieldsT &... fields) noexcept : i_fields (fields...) {}
+
+   RowReference (RowReference const &) = default;
+
+   RowReference & operator = (RowReference const & other) {i_fields = other.i_fields; return *this;}
+
+   RowReference & operator = (value_type const & values) {i_fields = values; return *this;}
+
+   RowReference & operator = (value_type && values) {i_fields = std::move (values); return *this;}
+
+   operator value_type () const {return value_type (i_fields);}
+
+   template <std::size_t IndexV>
+   auto &   get () const noexcept {return std::get<IndexV> (i_fields);}
+
+   friend void Swap (RowReference first, RowReference second) {first.i_fields.swap (second.i_fields);}
+
+private:
+
+   std::tuple <FieldsT &...> i_fields;
+};
+
+// Lets comparators written against value_type, e.g. [] (auto const & a, auto const & b) {return get<0> (a) < get<0> (b);},
+// take row references as well.
+template <std::size_t IndexV, typename... FieldsT>
+auto & get (RowReference<FieldsT...> const & row) noexcept
+{
+   return row.template get<IndexV> ();
+}
+
+template <typename SequenceT>
+class SoA;
+
+// Structure of arrays: one std::vector per field of FieldsT, all of the same length, so that a pass
+// over one field only brings that field's bytes through the cache. Records are reached through
+// random access iterators whose references are RowReference proxies.
+template <typename... FieldsT>
+class SoA <tmp::TypeSequence<FieldsT...>>
+{
+   static_assert (sizeof... (FieldsT) > 0, "an SoA needs at least one field");
+
+   static_assert (!(std::is_same_v <std::remove_cv_t<FieldsT>, bool> || ...), "std::vector<bool> has neither data () nor bool &: store flags as std::uint8_t");
+
+public:
+
+   template <std::size_t IndexV>
+   using field_type        = std::tuple_element_t <IndexV, std::tuple<FieldsT...>>;
+
+   using value_type        = std::tuple <FieldsT...>;
+
+   using reference         = RowReference <FieldsT...>;
+
+   using const_reference   = RowReference <FieldsT const...>;
+
+   using size_type         = std::size_t;
+
+   using difference_type   = std::ptrdiff_t;
+
+   #pragma region Iterator
+
+private:
+
+   template <bool ConstV> class iterator_base;
+
+public:
+
+   using iterator          = iterator_base <false>;
+
+   using const_iterator    = iterator_base <true>;
+
+   iterator          begin    () noexcept {return iterator (this, 0);}
+   iterator          end      () noexcept {return iterator (this, size ());}
+   const_iterator    begin    () const noexcept {return const_iterator (this, 0);}
+   const_iterator    end      () const noexcept {return const_iterator (this, size ());}
+   const_iterator    cbegin   () const noexcept {return begin ();}
+   const_iterator    cend     () const noexcept {return end ();}
+
+   #pragma endregion
+
+   #pragma region Accessors
+
+   size_type         size     () const noexcept {return std::get<0> (i_columns).size ();}
+
+   bool              empty    () const noexcept {return size () == 0;}
+
+   reference         operator [] (size_type index) noexcept {return Row<reference> (*this, index, std::index_sequence_for<FieldsT...> {});}
+
+   const_reference   operator [] (size_type index) const noexcept {return Row<const_reference> (*this, index, std::index_sequence_for<FieldsT...> {});}
+
+   template <std::size_t IndexV>
+   ColumnView <field_type<IndexV>>        column () noexcept {return ColumnView <field_type<IndexV>> (std::get<IndexV> (i_columns).data (), size ());}
+
+   template <std::size_t IndexV>
+   ColumnView <field_type<IndexV> const>  column () const noexcept {return ColumnView <field_type<IndexV> const> (std::get<IndexV> (i_columns).data (), size ());}
+
+   #pragma endregion
+
+   #pragma region Modifiers
+
+   // Strong guarantee: if constructing a field throws, the fields already appended are removed
+   // again, so every column keeps the same length.
+   template <typename... ArgsT>
+   void  emplace_back (ArgsT&&... fields);
+
+   void  push_back    (value_type const & values);
+
+   void  reserve      (size_type capacity);
+
+   void  resize       (size_type size);
+
+   void  clear        () noexcept;
+
+   // Stable sort of the records on field IndexV: only the key column and an index permutation are
+   // sorted, then every column is permuted once. Integral keys of up to 32 bits in their natural
+   // order are packed with their record index in 64 bit words and radix sorted on the key bytes
+   // alone; other keys are merge sorted through the permutation.
+   template <std::size_t IndexV, typename CompareT = std::less <field_type<IndexV>>>
+   void  SortByColumn (CompareT const & compare = CompareT ());
+
+   #pragma endregion
+
+private:
+
+   #pragma region iterator base
+
+   template <bool ConstV>
+   class iterator_base
+   {
+      using self_t = iterator_base <ConstV>;
+
+      using container_t = std::conditional_t <ConstV, SoA const, SoA>;
+
+   public:
+
+      using iterator_category = std::random_access_iterator_tag;
+
+      using value_type        = SoA::value_type;
+
+      using difference_type   = SoA::difference_type;
+
+      using pointer           = void;
+
+      using reference         = std::conditional_t <ConstV, const_reference, SoA::reference>;
+
+      iterator_base () noexcept : i_container (nullptr), i_index (0) {}
+
+      iterator_base (container_t * container, size_type index) noexcept : i_container (container), i_index (index) {}
+
+      template <bool OtherConstV, typename = std::enable_if_t <ConstV && !OtherConstV>>
+      iterator_base (iterator_base <OtherConstV> const & it) noexcept : i_container (it.i_container), i_index (it.i_index) {}
+
+      reference   operator *  () const {return (*i_container) [i_index];}
+
+      reference   operator [] (difference_type offset) const {return (*i_container) [i_index + offset];}
+
+      self_t & operator ++ ()    {++i_index; return *this;}
+
+      self_t   operator ++ (int) {auto result = *this; ++(*this); return result;}
+
+      self_t & operator -- ()    {--i_index; return *this;}
+
+      self_t   operator -- (int) {auto result = *this; --(*this); return result;}
+
+      self_t & operator += (difference_type offset) {i_index += offset; return *this;}
+
+      self_t & operator -= (difference_type offset) {i_index -= offset; return *this;}
+
+      self_t   operator +  (difference_type offset) const {return self_t (i_container, i_index + offset);}
+
+      self_t   operator -  (difference_type offset) const {return self_t (i_container, i_index - offset);}
+
+      friend self_t operator + (difference_type offset, self_t it) {return it + offset;}
+
+      difference_type operator - (self_t it) const {return static_cast<difference_type> (i_index) - static_cast<difference_type> (it.i_index);}
+
+      bool     operator == (self_t it) const {return i_index == it.i_index;}
+
+      bool     operator != (self_t it) const {return i_index != it.i_index;}
+
+      bool     operator <  (self_t it) const {return i_index < it.i_index;}
+
+      bool     operator >  (self_t it) const {return i_index > it.i_index;}
+
+      bool     operator <= (self_t it) const {return i_index <= it.i_index;}
+
+      bool     operator >= (self_t it) const {return i_index >= it.i_index;}
+
+   private:
+
+      template <bool> friend class iterator_base;
+
+      container_t *  i_container;
+      size_type      i_index;
+   };
+
+   #pragma endregion
+
+   template <typename ReferenceT, typename SelfT, std::size_t... IndicesV>
+   static ReferenceT Row (SelfT & self, size_type index, std::index_sequence<IndicesV...>) noexcept
+   {
+      return ReferenceT (std::get<IndicesV> (self.i_columns) [index]...);
+   }
+
+   template <std::size_t... IndicesV, typename... ArgsT>
+   void EmplaceBack (std::index_sequence<IndicesV...>, ArgsT&&... fields);
+
+   // Reorders every column so that record i becomes the former record order [i].
+   void Permute (std::vector<size_type> const & order);
+
+   std::tuple <std::vector<FieldsT>...> i_columns;
+};
+
+template < typename... FieldsT >
+template < typename... ArgsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::emplace_back (ArgsT&&... fields)
+{
+   static_assert (sizeof... (ArgsT) == sizeof... (FieldsT), "emplace_back takes one argument per field");
+
+   EmplaceBack (std::index_sequence_for<FieldsT...> {}, std::forward<ArgsT> (fields)...);
+}
+
+template < typename... FieldsT >
+template < std::size_t... IndicesV, typename... ArgsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::EmplaceBack (std::index_sequence<IndicesV...>, ArgsT&&... fields)
+{
+   std::size_t appended = 0;
+
+   auto append = [&appended] (auto & column, auto && field)
+   {
+      column.emplace_back (std::forward<decltype (field)> (field));
+      ++appended;
+   };
+
+   try
+   {
+      (append (std::get<IndicesV> (i_columns), std::forward<ArgsT> (fields)), ...);
+   }
+   catch (...)
+   {
+      ((IndicesV < appended ? std::get<IndicesV> (i_columns).pop_back () : void ()), ...);
+      throw;
+   }
+}
+
+template < typename... FieldsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::push_back (value_type const & values)
+{
+   std::apply ([this] (auto const &... fields) {emplace_back (fields...);}, values);
+}
+
+template < typename... FieldsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::reserve (size_type capacity)
+{
+   std::apply ([capacity] (auto &... columns) {(columns.reserve (capacity), ...);}, i_columns);
+}
+
+template < typename... FieldsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::resize (size_type size)
+{
+   std::apply ([size] (auto &... columns) {(columns.resize (size), ...);}, i_columns);
+}
+
+template < typename... FieldsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::clear () noexcept
+{
+   std::apply ([] (auto &... columns) {(columns.clear (), ...);}, i_columns);
+}
+
+template < typename... FieldsT >
+template < std::size_t IndexV, typename CompareT >
+void SoA <tmp::TypeSequence<FieldsT...>>::SortByColumn (CompareT const & compare)
+{
+   using KeyT = field_type<IndexV>;
+
+   auto const & keys = std::get<IndexV> (i_columns);
+   auto const count = size ();
+
+   std::vector<size_type> order (count);
+
+   constexpr bool radixEligible = std::is_integral_v<KeyT> && !std::is_same_v<KeyT, bool> && sizeof (KeyT) <= sizeof (std::uint32_t)
+                               && IsDefaultCompare <CompareT, KeyT>;
+
+   if constexpr (radixEligible)
+   {
+      if (count <= UINT32_MAX)
+      {
+         using UnsignedT = std::make_unsigned_t<KeyT>;
+
+         // Biased key in the high half, record index in the low half. The words start in index order
+         // and LSD radix sorting is stable, so sorting on the key bytes alone keeps ties in their
+         // original order.
+         constexpr UnsignedT signFlip = std::is_signed_v<KeyT> ? static_cast<UnsignedT> (UnsignedT (1) << (8 * sizeof (KeyT) - 1)) : UnsignedT (0);
+
+         std::vector<std::uint64_t> packed (count);
+
+         for (size_type index = 0; index < count; ++index)
+         {
+            packed [index] = std::uint64_t (static_cast<UnsignedT> (static_cast<UnsignedT> (keys [index]) ^ signFlip)) << 32 | index;
+         }
+
+         RadixSort (packed.begin (), packed.end (), [] (std::uint64_t word) {return static_cast<UnsignedT> (word >> 32);});
+
+         for (size_type index = 0; index < count; ++index) order [index] = static_cast<size_type> (packed [index] & UINT32_MAX);
+
+         Permute (order);
+
+         return;
+      }
+   }
+
+   std::iota (order.begin (), order.end (), size_type (0));
+
+   std::vector<size_type> buffer (count);
+
+   MergeSort (order.begin (), order.end (), buffer.begin (), [&keys, &compare] (size_type left, size_type right) {return compare (keys [left], keys [right]);});
+
+   Permute (order);
+}
+
+template < typename... FieldsT >
+void SoA <tmp::TypeSequence<FieldsT...>>::Permute (std::vector<size_type> const & order)
+{
+   std::apply ([&order] (auto &... columns)
+   {
+      auto permute = [&order] (auto & column)
+      {
+         std::remove_reference_t<decltype (column)> permuted;
+
+         permuted.reserve (column.size ());
+
+         for (auto index : order) permuted.push_back (std::move (column [index]));
+
+         column.swap (permuted);
+      };
+
+      (permute (columns), ...);
+   }, i_columns);
+}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tuple>
+#include <type_traits>
 
 namespace tmp
 {
@@ -41,7 +42,7 @@ struct TypeToTypeConverter {};
 template <template <typename ArgT> class ConverterT, typename ArgFirstT, typename... ArgsT>
 struct TypeToTypeConverter <ConverterT, ArgFirstT, ArgsT...>
 {
-   using type = TypeSequence < TypeToTypeConverter <ConverterT, ArgFirstT>::type, TypeToTypeConverter<ConverterT, ArgsT...>::type >::type;
+   using type = typename TypeSequence < typename TypeToTypeConverter <ConverterT, ArgFirstT>::type, typename TypeToTypeConverter<ConverterT, ArgsT...>::type >::type;
 };
 
 template <template <typename ArgT> class ConverterT, typename T>
@@ -69,6 +70,10 @@ struct TypeToValueConverter<ConverterT, T>
    static constexpr auto value = std::make_tuple (ConverterT<T>::value);
 };
 
+// Converts the elements of a sequence, so that tables can be built from a named TypeSequence.
+template <template <typename ArgT> class ConverterT, typename... ArgsT>
+struct TypeToValueConverter<ConverterT, TypeSequence<ArgsT...>> : TypeToValueConverter<ConverterT, ArgsT...> {};
+
 #pragma endregion
 
 }
@@ -77,7 +82,11 @@ struct TypeToValueConverter<ConverterT, T>
 
 #include <iterator>
 
-template <typename T> using Converter_t = std::is_same<T, std::random_access_iterator_tag>::type;
+// Compile-time self checks, kept out of the global namespace of every includer.
+namespace tmp::tests
+{
+
+template <typename T> using Converter_t = typename std::is_same<T, std::random_access_iterator_tag>::type;
 
 template <typename T> using Converter_v = std::is_same<T, std::random_access_iterator_tag>;
 
@@ -91,5 +100,9 @@ static_assert (r1, "");
 
 static_assert (r2 == std::make_tuple (false, true, false, false, false), "");
 
+static_assert (tmp::TypeToValueConverter<Converter_v, tmp::TypeSequence<std::input_iterator_tag, std::random_access_iterator_tag>>::value == std::make_tuple (false, true), "");
+
+}
+
 #pragma endregion
 
@@ -1,8 +1,21 @@
 #include <algorithm>
+#include <filesystem>
+#include <forward_list>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "BinarySearchTree.h"
+#include "IntrusiveSearchTree.h"
+#include "MappedSortedArray.h"
+#include "PersistentSearchTree.h"
+#include "SortedTable.h"
+#include "StaticSearchIndex.h"
+#include "StructureOfArrays.h"
 #include "Sorting.h"
 
 using namespace std;
@@ -85,6 +98,445 @@ void TreeTest ()
     cout << tree.empty () << endl;
 }
 
+void OrderStatisticsTest ()
+{
+    BinarySearchTree<int, std::less<int>, tree_options::OrderStatistics> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    cout << tree.rank (6) << " " << tree.rank (9) << " " << tree.rank (0) << " " << tree.rank (20) << endl;
+
+    for (size_t k = 0; k < 9; ++k) cout << *tree.select (k) << " ";
+    cout << boolalpha << (tree.select (9) == tree.end ()) << endl;
+
+    cout << tree.count_range (4, 11) << " " << tree.count_range (11, 4) << endl;
+
+    auto it = tree.advance (tree.begin (), 4);
+    cout << *it << " " << tree.distance (tree.begin (), it) << " " << tree.distance (it, tree.end ()) << endl;
+    cout << *tree.advance (it, -2) << " " << (tree.advance (it, 5) == tree.end ()) << endl;
+
+    tree.erase (tree.find (3));
+    tree.erase (tree.find (8));
+    tree.rotateLeft (tree.find (4));
+    tree.rotateRight (tree.find (13));
+    for (auto N : tree) cout << N << " ";
+    cout << endl;
+
+    for (size_t k = 0; k < 7; ++k) cout << *tree.select (k) << " ";
+    cout << tree.rank (13) << endl;
+}
+
+void RangeLookupTest ()
+{
+    BinarySearchTree<int> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    cout << *tree.lower_bound (5) << " " << *tree.lower_bound (6) << " " << *tree.upper_bound (6) << endl;
+    cout << boolalpha << (tree.lower_bound (15) == tree.end ()) << " " << (tree.upper_bound (14) == tree.end ()) << endl;
+
+    auto range = tree.equal_range (7);
+    cout << *range.first << " " << *range.second << endl;
+
+    range = tree.equal_range (9);
+    cout << (range.first == range.second) << " " << *range.first << endl;
+
+    for (auto it = tree.lower_bound (4); it != tree.upper_bound (10); ++it) cout << *it << " ";
+    cout << endl;
+
+    BinarySearchTree<string, less<>> names {"delta", "alpha", "charlie", "bravo"};
+
+    string_view key = "charlie";
+    cout << *names.find (key) << " " << *names.lower_bound (string_view ("b")) << " " << (names.find (string_view ("echo")) == names.end ()) << endl;
+
+    BinarySearchTree<string, less<>, tree_options::OrderStatistics> ranked {"delta", "alpha", "charlie", "bravo"};
+
+    cout << ranked.rank (key) << " " << ranked.count_range (string_view ("b"), string_view ("d")) << endl;
+}
+
+struct Counted
+{
+    static int constructions;
+
+    Counted (int key, string name) : key (key), name (std::move (name)) {++constructions;}
+    Counted (Counted const & other) : key (other.key), name (other.name) {++constructions;}
+    Counted (Counted && other) : key (other.key), name (std::move (other.name)) {++constructions;}
+
+    bool operator < (Counted const & other) const {return key < other.key;}
+
+    int key;
+    string name;
+};
+
+int Counted::constructions = 0;
+
+void EmplaceHintTest ()
+{
+    BinarySearchTree<Counted> tree;
+
+    tree.emplace (2, "two");
+    tree.emplace (1, "one");
+    tree.emplace (2, "deux");
+    cout << Counted::constructions << " " << tree.find (Counted (2, "")) ->name << endl;
+
+    BinarySearchTree<int> series;
+
+    for (int N = 0; N < 10; ++N) series.emplace_hint (series.end (), N * 2);
+
+    auto it = series.insert (series.find (6), 5);
+    cout << *it << " " << *series.insert (series.find (6), 6) << " " << *series.emplace_hint (series.begin (), 11) << endl;
+
+    for (auto N : series) cout << N << " ";
+    cout << endl;
+}
+
+void ThreadedTreeTest ()
+{
+    BinarySearchTree<int, std::less<int>, tree_options::Threaded> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    cout << tree.size () << " " << *tree.begin () << endl;
+
+    tree.erase (tree.find (8));
+    tree.erase (tree.find (1));
+    tree.erase (tree.find (14));
+    tree.emplace (0);
+    tree.emplace_hint (tree.end (), 20);
+
+    for (auto N : tree) cout << N << " ";
+    cout << tree.size () << endl;
+
+    for (auto it = tree.find (20); it != tree.end (); --it) cout << *it << " ";
+    cout << endl;
+}
+
+void PersistentTreeTest ()
+{
+    PersistentSearchTree<int> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    auto snapshot = tree.snapshot ();
+
+    tree.erase (8);
+    tree.erase (3);
+    tree.emplace (5);
+    cout << tree.insert (5) << " " << tree.erase (42) << endl;
+
+    for (auto N : tree) cout << N << " ";
+    cout << tree.size () << endl;
+
+    for (auto N : snapshot) cout << N << " ";
+    cout << snapshot.size () << endl;
+
+    cout << *snapshot.find (3) << " " << (tree.find (3) == tree.end ()) << " " << *tree.lower_bound (8) << " " << *tree.upper_bound (10) << endl;
+
+    BinarySearchTree<int> copy (BinarySearchTree<int> {2, 1, 3});
+    BinarySearchTree<int> deepCopy (copy);
+    for (auto N : deepCopy) cout << N << " ";
+    cout << endl;
+}
+
+void ParallelCopyTest ()
+{
+    // A degenerate chain deep enough to overflow a recursive copy or teardown.
+    BinarySearchTree<int> chain;
+    for (int N = 0; N < 1000000; ++N) chain.emplace_hint (chain.end (), N);
+
+    BinarySearchTree<int> copy (chain);
+    cout << copy.size () << " " << equal (copy.begin (), copy.end (), chain.begin (), chain.end ()) << endl;
+    copy.clear ();
+
+    BinarySearchTree<int, std::less<int>, tree_options::OrderStatistics> tree;
+    for (int N = 0; N < 100000; ++N) tree.emplace ((N * 7919) % 100003);
+
+    decltype (tree) parallelCopy (tree, 4);
+    cout << parallelCopy.size () << " " << equal (parallelCopy.begin (), parallelCopy.end (), tree.begin (), tree.end ()) << " " << *parallelCopy.select (500) << endl;
+
+    parallelCopy.clear (4);
+    chain.clear (4);
+    cout << parallelCopy.empty () << " " << chain.empty () << endl;
+}
+
+void MappedSortedArrayTest ()
+{
+    BinarySearchTree<int> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    auto path = (filesystem::temp_directory_path () / "googleprep_sorted_array.bin").string ();
+
+    SaveSortedArray (path, tree);
+
+    {
+        MappedSortedArray<int> image (path);
+
+        cout << image.size () << " " << *image.find (6) << " " << (image.find (5) == image.end ()) << " " << *image.lower_bound (5) << " " << *image.upper_bound (10) << endl;
+
+        BinarySearchTree<int, std::less<int>, tree_options::OrderStatistics> loaded (sorted_unique, image.begin (), image.end ());
+        loaded.emplace (5);
+        for (auto N : loaded) cout << N << " ";
+        cout << loaded.size () << " " << *loaded.select (4) << endl;
+    }
+
+    // A short range is rejected and leaves the previous image in place.
+    vector<int> values {1, 2, 3};
+
+    try { SaveSortedArray (path, values.begin (), values.end (), 4); } catch (invalid_argument const &) { cout << "rejected "; }
+
+    cout << MappedSortedArray<int> (path).size () << " " << filesystem::exists (path + ".tmp") << endl;
+
+    filesystem::remove (path);
+}
+
+void StaticSearchIndexTest ()
+{
+    BinarySearchTree<int> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    auto index = Freeze (tree);
+
+    for (auto N : index) cout << N << " ";
+    cout << index.size () << endl;
+    cout << *index.find (7) << " " << (index.find (5) == index.end ()) << " " << *index.lower_bound (5) << " " << *index.upper_bound (10) << " " << (index.lower_bound (15) == index.end ()) << endl;
+
+    StaticBlockSearchIndex<int, std::less<int>, 4> blocks (tree.begin (), tree.end ());
+
+    for (auto N : blocks) cout << N << " ";
+    cout << blocks.size () << endl;
+    cout << *blocks.find (7) << " " << (blocks.find (5) == blocks.end ()) << " " << *blocks.lower_bound (5) << " " << *blocks.upper_bound (10) << " " << (blocks.lower_bound (15) == blocks.end ()) << endl;
+}
+
+// Compares every lookup of an index of sorted against std::lower_bound / std::upper_bound, for
+// every probe from below the smallest to above the largest value; returns the number of mismatches.
+template <typename IndexT>
+size_t StaticIndexMismatches (vector<int> const & sorted)
+{
+    IndexT index (sorted.begin (), sorted.end ());
+
+    auto same = [&] (auto it, vector<int>::const_iterator expected)
+    {
+        return (it == index.end ()) == (expected == sorted.end ()) && (it == index.end () || *it == *expected);
+    };
+
+    size_t mismatches = index.size () != sorted.size ();
+    int const last = sorted.empty () ? 0 : sorted.back () + 1;
+
+    for (int probe = -1; probe <= last; ++probe)
+    {
+        auto const lower = lower_bound (sorted.begin (), sorted.end (), probe);
+        bool const present = lower != sorted.end () && *lower == probe;
+
+        mismatches += !same (index.lower_bound (probe), lower);
+        mismatches += !same (index.upper_bound (probe), upper_bound (sorted.begin (), sorted.end (), probe));
+        mismatches += (index.find (probe) != index.end ()) != present;
+    }
+
+    return mismatches;
+}
+
+void StaticSearchIndexRandomTest ()
+{
+    mt19937 random (7);
+
+    // Sorted values with gaps of 0 to 2, so that there are duplicates, hits and misses.
+    auto values = [&random] (size_t size)
+    {
+        vector<int> result (size);
+        int value = 0;
+        for (auto & N : result) N = value += int (random () % 3);
+        return result;
+    };
+
+    // Block boundaries for 16-key blocks (int) and 4-key blocks, one to three levels of nodes deep.
+    vector<size_t> sizes {0, 1, 3, 4, 5, 15, 16, 17, 19, 20, 21, 99, 100, 101, 271, 272, 273, 499, 500, 501, 4623, 4624, 4625};
+
+    for (int N = 0; N < 8; ++N) sizes.push_back (random () % 6000);
+
+    size_t eytzinger = 0, lineBlocks = 0, smallBlocks = 0;
+
+    for (auto size : sizes)
+    {
+        auto sorted = values (size);
+
+        eytzinger   += StaticIndexMismatches<StaticSearchIndex<int>> (sorted);
+        lineBlocks  += StaticIndexMismatches<StaticBlockSearchIndex<int>> (sorted);
+        smallBlocks += StaticIndexMismatches<StaticBlockSearchIndex<int, std::less<int>, 4>> (sorted);
+    }
+
+    cout << sizes.size () << " sizes, mismatches " << eytzinger << " " << lineBlocks << " " << smallBlocks << endl;
+}
+
+void SetOperationsTest ()
+{
+    using Tree = BinarySearchTree<int, std::less<int>, tree_options::WeightBalanced>;
+
+    auto print = [] (Tree const & tree) {for (auto N : tree) cout << N << " "; cout << tree.size () << endl;};
+
+    Tree first {1, 3, 5, 7, 9, 11};
+
+    first.set_union (Tree {2, 3, 4, 5, 12}, 2);
+    print (first);
+
+    first.set_intersection (Tree {1, 2, 5, 9, 10, 12, 13});
+    print (first);
+
+    first.set_difference (Tree {2, 12});
+    print (first);
+
+    auto upper = first.split (5);
+    print (first);
+    print (upper);
+
+    first.join (std::move (upper));
+    print (first);
+    cout << upper.empty () << endl;
+}
+
+void SplayTreeTest ()
+{
+    BinarySearchTree<int, std::less<int>, tree_options::Splay, tree_options::OrderStatistics> tree {8, 3, 1, 6, 4, 7, 10, 14, 13};
+
+    for (int i = 0; i < 64; ++i) tree.find (i % 2 ? 13 : 1);
+
+    for (auto N : {13, 1, 13, 7, 4}) cout << *tree.find (N) << " ";
+    cout << (tree.find (5) == tree.end ()) << endl;
+
+    tree.erase (tree.find (6));
+    tree.emplace (5);
+    tree.emplace_hint (tree.end (), 20);
+
+    for (auto N : tree) cout << N << " ";
+    cout << tree.size () << endl;
+
+    cout << tree.rank (10) << " " << *tree.select (4) << endl;
+}
+
+struct Order : IntrusiveTreeHook<>
+{
+    Order (int id) : id (id) {}
+
+    bool operator < (Order const & other) const {return id < other.id;}
+
+    int id;
+};
+
+void IntrusiveTreeTest ()
+{
+    vector<Order> pool {8, 3, 1, 6, 4, 7, 10, 14, 13, 6};
+
+    IntrusiveSearchTree<Order> tree;
+
+    for (auto & order : pool) cout << tree.insert (order).second;
+    cout << " " << tree.size () << endl;
+
+    pool [3].unlink ();
+    tree.erase (tree.find (Order (1)));
+    tree.erase (pool [7]);
+
+    for (auto & order : tree) cout << order.id << " ";
+    cout << tree.size () << " " << pool [3].is_linked () << pool [0].is_linked () << endl;
+
+    for (auto it = tree.rbegin (); it != tree.rend (); ++it) cout << it->id << " ";
+    cout << tree.lower_bound (Order (5))->id << " " << (tree.upper_bound (Order (13)) == tree.end ()) << endl;
+
+    {
+        Order transient (9);
+        tree.insert (transient);
+        cout << tree.size () << " ";
+    }
+    cout << tree.size () << endl;
+}
+
+void DispatchSortTest ()
+{
+    vector<int> numbers (100);
+    for (int N = 0; N < 100; ++N) numbers [N] = (N * 37) % 101 - 50;
+
+    Sort (numbers.begin (), numbers.end ());
+    cout << numbers.front () << " " << numbers.back () << " " << is_sorted (numbers.begin (), numbers.end ()) << endl;
+
+    forward_list<string> words {"pear", "apple", "fig", "kiwi"};
+
+    Sort (words.begin (), words.end (), std::greater<string> ());
+    for (auto const & word : words) cout << word << " ";
+    cout << endl;
+
+    vector<unique_ptr<int>> owned;
+    for (int N : {3, 1, 2}) owned.push_back (make_unique<int> (N));
+
+    Sort (owned.begin (), owned.end (), [] (auto const & left, auto const & right) {return *left < *right;});
+    for (auto const & N : owned) cout << *N << " ";
+    cout << endl;
+
+    list<unique_ptr<int>> linked;
+    for (int N : {4, 1, 3, 1, 2}) linked.push_back (make_unique<int> (N));
+
+    Sort (linked.begin (), linked.end (), [] (auto const & left, auto const & right) {return *left < *right;});
+    for (auto const & N : linked) cout << *N << " ";
+    cout << endl;
+}
+
+template <typename SortMethodT>
+constexpr std::array<int, 9> SortedAtCompileTime (SortMethodT SortMethod)
+{
+    std::array<int, 9> values {5, 2, 3, 7, 3, 8, 6, 9, 1};
+
+    SortMethod (values.begin (), values.end ());
+
+    return values;
+}
+
+template <typename T, size_t SizeV>
+constexpr bool IsAscending (std::array<T, SizeV> const & values)
+{
+    for (size_t N = 1; N < SizeV; ++N) if (values [N] < values [N - 1]) return false;
+    return true;
+}
+
+static_assert (IsAscending (SortedAtCompileTime ([] (auto first, auto last) { HeapMake (first, last); HeapSort (first, last); })), "");
+static_assert (IsAscending (SortedAtCompileTime ([] (auto first, auto last) { QuickSort (first, last); })), "");
+static_assert (IsAscending (SortedAtCompileTime ([] (auto first, auto last) { ForwardQuickSort (first, last); })), "");
+static_assert (IsAscending (SortedAtCompileTime ([] (auto first, auto last) { std::array<int, 9> buffer {}; MergeSort (first, last, buffer.begin ()); })), "");
+
+void SortedTableTest ()
+{
+    constexpr SortedTable keywords (std::array<string_view, 5> {"while", "if", "else", "return", "for"});
+
+    static_assert (keywords.contains ("return") && !keywords.contains ("goto"), "");
+    static_assert (keywords.lower_bound ("g") - keywords.begin () == 2, "");
+
+    for (auto keyword : keywords) cout << keyword << " ";
+    cout << endl;
+
+    constexpr auto opcodes = MakeSortedTable<tmp::TypeSequence<integral_constant<int, 0x40>, integral_constant<int, 0x10>, integral_constant<int, 0x2A>>> ();
+
+    static_assert (opcodes [0] == 0x10 && opcodes.find (0x2A) == opcodes.begin () + 1, "");
+
+    for (auto opcode : opcodes) cout << opcode << " ";
+    cout << (opcodes.find (0x11) == opcodes.end ()) << endl;
+}
+
+void StructureOfArraysTest ()
+{
+    SoA<tmp::TypeSequence<int, string, double>> records;
+
+    records.emplace_back (3, "carol", 2.5);
+    records.emplace_back (-1, "alice", 9.0);
+    records.emplace_back (3, "bob", 1.5);
+    records.emplace_back (0, "dave", 4.0);
+
+    auto print = [&records] {for (auto name : records.column<1> ()) cout << name << " "; cout << endl;};
+
+    records.SortByColumn<0> ();
+    print ();
+
+    records.SortByColumn<1> (std::greater<string> ());
+    print ();
+
+    QuickSort (records.begin (), records.end (), [] (auto const & left, auto const & right) {return get<2> (left) < get<2> (right);});
+    print ();
+
+    // A field that fails to construct leaves no partial record behind.
+    struct Unnamed {operator string () const {throw runtime_error ("no name");}};
+    try {records.emplace_back (7, Unnamed {}, 0.0);} catch (runtime_error const &) {}
+    cout << records.column<0> ().size () << " " << records.column<1> ().size () << " " << records.column<2> ().size () << endl;
+
+    double total = 0;
+    for (auto price : records.column<2> ()) total += price;
+    cout << records.size () << " " << total << " " << records [0].get<0> () << endl;
+}
+
 int main (int argc, char** argv)
 {
     SortTest ([] (auto first, auto second) { HeapMake (first, second); HeapSort (first, second); });
@@ -92,6 +544,21 @@ int main (int argc, char** argv)
     SortTest ([] (auto first, auto second) { QuickSort (first, second); });
 
     TreeTest ();
+    OrderStatisticsTest ();
+    RangeLookupTest ();
+    EmplaceHintTest ();
+    ThreadedTreeTest ();
+    PersistentTreeTest ();
+    ParallelCopyTest ();
+    MappedSortedArrayTest ();
+    StaticSearchIndexTest ();
+    StaticSearchIndexRandomTest ();
+    SetOperationsTest ();
+    SplayTreeTest ();
+    IntrusiveTreeTest ();
+    DispatchSortTest ();
+    SortedTableTest ();
+    StructureOfArraysTest ();
 
     return 0;
 }